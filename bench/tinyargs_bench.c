@@ -0,0 +1,272 @@
+/**
+ * @file tinyargs_bench.c
+ * @brief Microbenchmark for the argument parser library.
+ *
+ * Measures parse throughput (tokens per second) and lookup latency over a grid
+ * of option counts, argv lengths and naming workloads, and prints the results
+ * as a single JSON document for tracking over time.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "tinyargs.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @enum bench_names_t
+ * @brief Which option names a workload registers and puts on the command line.
+ */
+typedef enum {
+    BENCH_NAMES_LONG,     /**< Only `--long` names */
+    BENCH_NAMES_SHORT,    /**< Only `-s` names */
+    BENCH_NAMES_MIXED,    /**< Both names registered, either one used */
+    BENCH_NAMES_KEYVALUE  /**< Only `--long` names, values attached as `--long=value` */
+} bench_names_t;
+
+static const char *const bench_names_str[] = { "long", "short", "mixed", "keyvalue" };
+
+static const int bench_option_counts[] = { 10, 100, 1000, 10000 };
+static const int bench_token_counts[] = { 16, 256, 4096 };
+
+/**
+ * @struct bench_case_t
+ * @brief One registered schema and a generated argv to parse against it.
+ */
+typedef struct {
+    arg_parser_t *parser;
+    char **short_names;
+    char **long_names;
+    char **attached;
+    arg_id_t *ids;
+    int options;
+    char **argv;
+    int argc;
+} bench_case_t;
+
+static double bench_now(void) {
+    struct timespec ts;
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* xorshift32, so every run generates the same argv vectors. */
+static uint32_t bench_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static char* bench_strdup(const char *text) {
+    size_t len = strlen(text) + 1;
+    char *copy = (char *)malloc(len);
+    memcpy(copy, text, len);
+    return copy;
+}
+
+/* Short names are `-` followed by `i` in base 52, so 10,000 options fit in three letters. */
+static char* bench_short_name(int i) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    char buf[16];
+    int len = 0;
+    buf[len++] = '-';
+    do {
+        buf[len++] = letters[i % 52];
+        i /= 52;
+    } while (i);
+    buf[len] = '\0';
+    return bench_strdup(buf);
+}
+
+static char* bench_long_name(int i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "--option-%d", i);
+    return bench_strdup(buf);
+}
+
+static bool bench_case_init(bench_case_t *bc, bench_names_t names, int options, int tokens) {
+    memset(bc, 0, sizeof(*bc));
+    bc->parser = arg_parser_create();
+    bc->short_names = (char **)calloc((size_t)options, sizeof(char *));
+    bc->long_names = (char **)calloc((size_t)options, sizeof(char *));
+    bc->attached = (char **)calloc((size_t)options, sizeof(char *));
+    bc->ids = (arg_id_t *)calloc((size_t)options, sizeof(arg_id_t));
+    bc->argv = (char **)calloc((size_t)tokens + 2, sizeof(char *));
+    if (!bc->parser || !bc->short_names || !bc->long_names || !bc->attached || !bc->ids || !bc->argv) {
+        return false;
+    }
+    bc->options = options;
+    arg_parser_reserve(bc->parser, options);
+    for (int i = 0; i < options; i++) {
+        if (names == BENCH_NAMES_SHORT || names == BENCH_NAMES_MIXED) {
+            bc->short_names[i] = bench_short_name(i);
+        }
+        if (names != BENCH_NAMES_SHORT) {
+            bc->long_names[i] = bench_long_name(i);
+        }
+        /* Every fourth option takes a value. */
+        arg_type_t type = (i % 4 == 3) ? ARG_TYPE_VALUE : ARG_TYPE_FLAG;
+        if (names == BENCH_NAMES_KEYVALUE && type == ARG_TYPE_VALUE) {
+            char buf[48];
+            snprintf(buf, sizeof(buf), "%s=value", bc->long_names[i]);
+            bc->attached[i] = bench_strdup(buf);
+        }
+        bc->ids[i] = arg_parser_add(bc->parser, bc->short_names[i], bc->long_names[i], type, false, "benchmark option");
+    }
+    arg_parser_freeze(bc->parser);
+
+    uint32_t seed = 0x9e3779b9u ^ (uint32_t)(options * 31 + tokens);
+    bc->argv[bc->argc++] = "tinyargs_bench";
+    while (bc->argc <= tokens) {
+        int i = (int)(bench_rand(&seed) % (uint32_t)options);
+        bool use_short = names == BENCH_NAMES_SHORT || (names == BENCH_NAMES_MIXED && (bench_rand(&seed) & 1));
+        if (bc->attached[i]) {
+            bc->argv[bc->argc++] = bc->attached[i];
+            continue;
+        }
+        bc->argv[bc->argc++] = use_short ? bc->short_names[i] : bc->long_names[i];
+        if (i % 4 == 3) {
+            bc->argv[bc->argc++] = "value";
+        }
+    }
+    return true;
+}
+
+static void bench_case_free(bench_case_t *bc) {
+    for (int i = 0; i < bc->options; i++) {
+        free(bc->short_names[i]);
+        free(bc->long_names[i]);
+        free(bc->attached[i]);
+    }
+    free(bc->short_names);
+    free(bc->long_names);
+    free(bc->attached);
+    free(bc->ids);
+    free(bc->argv);
+    arg_parser_free(bc->parser);
+}
+
+/* Parses repeatedly for at least `min_time` seconds; returns tokens per second, or -1 on a parse error. */
+static double bench_parse(bench_case_t *bc, double min_time) {
+    long iterations = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+        if (!arg_parser_parse(bc->parser, bc->argc, bc->argv)) {
+            return -1;
+        }
+        iterations++;
+        elapsed = bench_now() - start;
+    } while (elapsed < min_time);
+    return (double)iterations * (double)(bc->argc - 1) / elapsed;
+}
+
+/* Average nanoseconds per lookup, by name when `by_name` is set and by handle otherwise. */
+static double bench_lookup(bench_case_t *bc, bool by_name, double min_time) {
+    volatile uintptr_t sink = 0;
+    long lookups = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+        for (int i = 0; i < bc->options; i++) {
+            if (by_name) {
+                const char *name = bc->long_names[i] ? bc->long_names[i] : bc->short_names[i];
+                sink += (uintptr_t)arg_parser_get_value(bc->parser, name);
+            } else {
+                sink += (uintptr_t)arg_parser_get_value_id(bc->parser, bc->ids[i]);
+            }
+        }
+        lookups += bc->options;
+        elapsed = bench_now() - start;
+    } while (elapsed < min_time);
+    (void)sink;
+    return elapsed * 1e9 / (double)lookups;
+}
+
+int main(int argc, char *argv[]) {
+    arg_parser_t *cli = arg_parser_create();
+    arg_parser_add(cli, "-h", "--help", ARG_TYPE_FLAG, false, "Show this help");
+    arg_parser_add(cli, "-t", "--min-time", ARG_TYPE_DURATION, false, "Minimum time per measurement (default 50ms)");
+    arg_parser_add(cli, "-n", "--max-options", ARG_TYPE_INT, false, "Largest option count to run (default 10000)");
+    arg_parser_add(cli, "-o", "--output", ARG_TYPE_VALUE, false, "Write the JSON report to this file instead of stdout");
+    if (!arg_parser_parse(cli, argc, argv)) {
+        arg_parser_free(cli);
+        return 2;
+    }
+    if (arg_parser_is_flag_set(cli, "--help")) {
+        arg_parser_print_help(cli);
+        arg_parser_free(cli);
+        return 0;
+    }
+    double min_time = (double)arg_parser_get_duration(cli, "--min-time", 50000000) * 1e-9;
+#ifdef TINYARGS_MAX_ARGS
+    int64_t max_options = arg_parser_get_int(cli, "--max-options", TINYARGS_MAX_ARGS);
+    int max_args = TINYARGS_MAX_ARGS;
+#else
+    int64_t max_options = arg_parser_get_int(cli, "--max-options", 10000);
+    int max_args = 0;
+#endif
+    const char *output = arg_parser_get_value(cli, "--output");
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "tinyargs_bench: cannot open %s\n", output);
+        arg_parser_free(cli);
+        return 1;
+    }
+
+    /* Storage per option, measured at the fixed capacity or at a 64-option schema. */
+    int footprint_n = max_args ? max_args : 64;
+    fprintf(out, "{\n  \"benchmark\": \"tinyargs\",\n  \"min_time_s\": %g,\n", min_time);
+    fprintf(out, "  \"footprint\": {\"max_args\": %d, \"parser_bytes\": %zu, \"bytes_per_option\": %zu},\n",
+            max_args, sizeof(arg_parser_t), ARG_PARSER_FOOTPRINT(footprint_n) / (size_t)footprint_n);
+    fprintf(out, "  \"results\": [");
+    bool first = true;
+    int status = 0;
+    for (int w = 0; w <= BENCH_NAMES_KEYVALUE; w++) {
+        for (size_t o = 0; o < sizeof(bench_option_counts) / sizeof(bench_option_counts[0]); o++) {
+            if (bench_option_counts[o] > max_options) {
+                continue;
+            }
+            for (size_t t = 0; t < sizeof(bench_token_counts) / sizeof(bench_token_counts[0]); t++) {
+                bench_case_t bc;
+                if (!bench_case_init(&bc, (bench_names_t)w, bench_option_counts[o], bench_token_counts[t])) {
+                    fprintf(stderr, "tinyargs_bench: out of memory\n");
+                    bench_case_free(&bc);
+                    status = 1;
+                    goto done;
+                }
+                double tokens_per_sec = bench_parse(&bc, min_time);
+                double name_ns = bench_lookup(&bc, true, min_time);
+                double id_ns = bench_lookup(&bc, false, min_time);
+                fprintf(out, "%s\n    {\"workload\": \"%s\", \"options\": %d, \"tokens\": %d, "
+                        "\"parse_tokens_per_sec\": %.0f, \"lookup_name_ns\": %.2f, \"lookup_id_ns\": %.2f}",
+                        first ? "" : ",", bench_names_str[w], bc.options, bc.argc - 1,
+                        tokens_per_sec, name_ns, id_ns);
+                first = false;
+                if (tokens_per_sec < 0) {
+                    status = 1;
+                }
+                bench_case_free(&bc);
+            }
+        }
+    }
+done:
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    arg_parser_free(cli);
+    return status;
+}
@@ -0,0 +1,1040 @@
+/**
+ * @file tinyargs_fuzz.c
+ * @brief Differential fuzzer for the argument parser library.
+ *
+ * Each input is decoded into a schema and an argument vector, which is then
+ * parsed by every backend: a parser built with `arg_parser_add`, a static
+ * table, a name matcher doing a plain linear scan (the reference for the hash
+ * index), a compiled schema file, a batch parse over the frozen schema, the
+ * streaming API and, for ASCII inputs, the wide API. The results of all of them
+ * are rendered to text and the program aborts if any two differ, or if they
+ * differ from a naive parser written here from the documented rules. The
+ * vector is also parsed by the parser tinyargs_gen emits for
+ * `fuzz/tinyargs_fuzz.schema`, and each token is classified by the library's
+ * scanner and by a byte-at-a-time one, at every alignment.
+ *
+ * The library is compiled into this file through the single header, so its
+ * internal classifier and converters are reachable.
+ *
+ * Built with libFuzzer (`TINYARGS_FUZZ_LIBFUZZER`), this file only provides
+ * `LLVMFuzzerTestOneInput`. Otherwise it has its own driver, which runs each
+ * file named on the command line (or standard input, for AFL), times the
+ * corpus with `--bench`, and writes the large-argv regression cases with
+ * `--generate`.
+ *
+ * An input is text. Lines up to the first empty line declare one argument
+ * each, as `short long type [required]` with `.` for a missing name and a type
+ * of `flag`, `value`, `int`, `double`, `size`, `duration` or `list`. Every
+ * later line is one token of the vector.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#define TINYARGS_IMPLEMENTATION
+#include "tinyargs.h"
+#ifdef TINYARGS_FUZZ_GEN
+#include "fuzz_gen_args.h"
+#endif
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define FUZZ_HAVE_GETPID 1
+#endif
+
+/* Schema lines past the limit are ignored; a fixed-capacity build lowers it to what fits. */
+#if defined(TINYARGS_MAX_ARGS) && TINYARGS_MAX_ARGS < 4096
+#define FUZZ_MAX_ARGS TINYARGS_MAX_ARGS
+#else
+#define FUZZ_MAX_ARGS 4096
+#endif
+#define FUZZ_MAX_NAME 64
+#define FUZZ_MAX_TOKENS (1 << 18)
+
+/**
+ * @struct fuzz_case_t
+ * @brief One decoded input: the argument table and the vector to parse.
+ */
+typedef struct {
+    arg_t *args;
+    int count;
+    int capacity;
+    char *text;                 /* Copy of the input, split into lines in place */
+    char **tokens;              /* `tokens[0]` is the program name */
+    int argc;
+    bool ascii;                 /* Whether every name and token is ASCII, so the wide API applies */
+} fuzz_case_t;
+
+/**
+ * @struct fuzz_text_t
+ * @brief Growable buffer a backend's results are rendered into.
+ */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} fuzz_text_t;
+
+static char fuzz_program[] = "tinyargs_fuzz";
+
+static void fuzz_printf(fuzz_text_t *text, const char *fmt, ...) {
+    va_list ap;
+    for (;;) {
+        size_t room = text->cap - text->len;
+        va_start(ap, fmt);
+        int n = vsnprintf(text->data ? text->data + text->len : NULL, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            abort();
+        }
+        if ((size_t)n < room) {
+            text->len += (size_t)n;
+            return;
+        }
+        size_t cap = text->cap ? text->cap * 2 : 4096;
+        while (cap - text->len <= (size_t)n) {
+            cap *= 2;
+        }
+        char *data = (char *)realloc(text->data, cap);
+        if (!data) {
+            abort();
+        }
+        text->data = data;
+        text->cap = cap;
+    }
+}
+
+/* Unknown type words fall back to `flag`, so every input still decodes to a schema. */
+static arg_type_t fuzz_type(const char *word) {
+    static const char *const names[] = { "flag", "value", "int", "double", "size", "duration", "list" };
+    for (size_t i = 0; word && i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(word, names[i]) == 0) {
+            return (arg_type_t)i;
+        }
+    }
+    return ARG_TYPE_FLAG;
+}
+
+/* Terminates the next space-separated word of `*line` in place, truncated to FUZZ_MAX_NAME bytes. */
+static char* fuzz_word(char **line) {
+    char *p = *line;
+    while (*p == ' ') {
+        p++;
+    }
+    if (!*p) {
+        return NULL;
+    }
+    size_t len = 0;
+    while (p[len] && p[len] != ' ') {
+        len++;
+    }
+    *line = p[len] ? p + len + 1 : p + len;
+    p[len < FUZZ_MAX_NAME ? len : FUZZ_MAX_NAME] = '\0';
+    return p;
+}
+
+static bool fuzz_is_ascii(const char *text) {
+    for (; *text; text++) {
+        if ((unsigned char)*text >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool fuzz_decode(fuzz_case_t *fc, const uint8_t *data, size_t size) {
+    memset(fc, 0, sizeof(*fc));
+    fc->text = (char *)malloc(size + 1);
+    fc->tokens = (char **)malloc(sizeof(char *) * (size + 2));
+    if (!fc->text || !fc->tokens) {
+        return false;
+    }
+    memcpy(fc->text, data, size);
+    fc->text[size] = '\0';
+    fc->ascii = true;
+    fc->tokens[fc->argc++] = fuzz_program;
+
+    char *line = fc->text;
+    char *end = fc->text + size;
+    bool in_schema = true;
+    while (line <= end) {
+        char *newline = (char *)memchr(line, '\n', (size_t)(end - line));
+        char *next = newline ? newline + 1 : end + 1;
+        if (newline) {
+            *newline = '\0';
+        }
+        /* An embedded NUL ends the line for every backend alike. */
+        if (in_schema) {
+            if (!*line) {
+                in_schema = false;
+            } else if (fc->count < FUZZ_MAX_ARGS) {
+                if (fc->count == fc->capacity) {
+                    int capacity = fc->capacity ? fc->capacity * 2 : 16;
+                    arg_t *args = (arg_t *)realloc(fc->args, sizeof(arg_t) * (size_t)capacity);
+                    if (!args) {
+                        return false;
+                    }
+                    fc->args = args;
+                    fc->capacity = capacity;
+                }
+                arg_t *arg = &fc->args[fc->count++];
+                memset(arg, 0, sizeof(*arg));
+                char *p = line;
+                for (int k = 0; k < 2; k++) {
+                    char *name = fuzz_word(&p);
+                    if (name && strcmp(name, ".") != 0) {
+                        fc->ascii = fc->ascii && fuzz_is_ascii(name);
+                        *(k ? &arg->long_name : &arg->short_name) = name;
+                    }
+                }
+                arg->type = fuzz_type(fuzz_word(&p));
+                const char *flag = fuzz_word(&p);
+                arg->required = flag && flag[0] == 'r';
+                arg->description = "fuzzed argument";
+            }
+        } else if (newline || line < end) {
+            if (fc->argc == FUZZ_MAX_TOKENS) {
+                break;
+            }
+            /* Response files are only expanded by arg_parser_parse, and would read the filesystem. */
+            if (line[0] == '@') {
+                line[0] = '%';
+            }
+            fc->ascii = fc->ascii && fuzz_is_ascii(line);
+            fc->tokens[fc->argc++] = line;
+        }
+        line = next;
+    }
+    return true;
+}
+
+static void fuzz_case_free(fuzz_case_t *fc) {
+    free(fc->args);
+    free(fc->text);
+    free(fc->tokens);
+}
+
+static void fuzz_discard(void *ctx, arg_output_t kind, const char *text, size_t len) {
+    (void)ctx;
+    (void)kind;
+    (void)text;
+    (void)len;
+}
+
+/* Schema the linear matcher scans; the fuzzer runs one input at a time. */
+static const arg_schema_t *fuzz_linear_schema;
+
+/* Reference matcher: the first argument, in registration order, with this short or long name. */
+static int fuzz_linear_lookup(const char *name, size_t len) {
+    const arg_schema_t *schema = fuzz_linear_schema;
+    for (int i = 0; i < schema->count; i++) {
+        const arg_key_t *key = &schema->keys[i];
+        if (key->short_name && key->short_len == len && memcmp(key->short_name, name, len) == 0) {
+            return i;
+        }
+        if (key->long_name && key->long_len == len && memcmp(key->long_name, name, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Renders everything a caller can observe about a parse. Token indices are
+ * left out, since the streaming backend indexes only the tokens it keeps;
+ * the tokens themselves are compared instead.
+ */
+static void fuzz_render(fuzz_text_t *out, const arg_schema_t *schema, const arg_result_t *result, int ok, const char *error) {
+    out->len = 0;
+    fuzz_printf(out, "ok=%d code=%d id=%d\n%s", ok, (int)result->error.code, ok ? -1 : result->error.id, ok ? "" : error);
+    if (!ok) {
+        return;
+    }
+    for (int id = 0; id < schema->count; id++) {
+        const char *value = arg_result_get_value_id(schema, result, id);
+        fuzz_printf(out, "%d set=%d value=%s", id, (int)arg_result_is_set_id(schema, result, id), value ? value : "(none)");
+        const arg_value_t *typed = arg_result_get_typed_id(schema, result, id);
+        if (typed) {
+            switch (schema->keys[id].type) {
+                case ARG_TYPE_INT: fuzz_printf(out, " int=%lld", (long long)typed->i); break;
+                case ARG_TYPE_DOUBLE: fuzz_printf(out, " double=%a", typed->d); break;
+                case ARG_TYPE_SIZE: fuzz_printf(out, " size=%llu", (unsigned long long)typed->size); break;
+                case ARG_TYPE_DURATION: fuzz_printf(out, " ns=%lld", (long long)typed->ns); break;
+                default: break;
+            }
+        }
+        int count = 0;
+        const arg_ref_t *items = arg_result_get_values(schema, result, id, &count);
+        for (int k = 0; k < count; k++) {
+            fuzz_printf(out, " [%s]", result->argv[items[k].index] + items[k].offset);
+        }
+        fuzz_printf(out, "\n");
+    }
+    arg_span_t span = arg_result_get_positionals(result);
+    fuzz_printf(out, "positionals=%d", span.count);
+    for (int k = 0; k < span.count; k++) {
+        fuzz_printf(out, " [%s]", result->argv[span.first + k]);
+    }
+    fuzz_printf(out, "\n");
+}
+
+/* Renders a parser's results, checking its own accessors against the result-level ones. */
+static void fuzz_render_parser(fuzz_text_t *out, arg_parser_t *parser, const arg_result_t *view, int ok) {
+    char error[512];
+    arg_parser_format_error(parser, error, sizeof(error));
+    fuzz_render(out, &parser->schema, view, ok, error);
+    for (int id = 0; ok && id < parser->schema.count; id++) {
+        const char *expected = arg_result_get_value_id(&parser->schema, view, id);
+        const char *actual = arg_parser_get_value_id(parser, id);
+        if ((expected || actual) && (!expected || !actual || strcmp(expected, actual) != 0)) {
+            fprintf(stderr, "tinyargs_fuzz: accessor mismatch for argument %d: %s vs %s\n", id,
+                    expected ? expected : "(none)", actual ? actual : "(none)");
+            abort();
+        }
+    }
+}
+
+static void fuzz_compare(const char *backend, const fuzz_text_t *reference, const fuzz_text_t *actual) {
+    if (reference->len != actual->len || memcmp(reference->data, actual->data, reference->len) != 0) {
+        fprintf(stderr, "tinyargs_fuzz: %s disagrees with arg_parser_add\n--- expected\n%.*s--- actual\n%.*s",
+                backend, (int)reference->len, reference->data, (int)actual->len, actual->data);
+        abort();
+    }
+}
+
+/* Each backend gets its own copy of the vector, since parsing reorders it. */
+static char** fuzz_vector(const fuzz_case_t *fc) {
+    char **argv = (char **)malloc(sizeof(char *) * (size_t)fc->argc);
+    if (!argv) {
+        abort();
+    }
+    memcpy(argv, fc->tokens, sizeof(char *) * (size_t)fc->argc);
+    return argv;
+}
+
+static arg_parser_t* fuzz_build(const fuzz_case_t *fc) {
+    arg_parser_t *parser = arg_parser_create();
+    if (!parser) {
+        abort();
+    }
+    arg_parser_set_output(parser, fuzz_discard, NULL);
+    for (int i = 0; i < fc->count; i++) {
+        const arg_t *arg = &fc->args[i];
+        arg_parser_add(parser, arg->short_name, arg->long_name, arg->type, arg->required, arg->description);
+    }
+    return parser;
+}
+
+/* Byte-at-a-time classification, the reference for the library's block scanner. */
+static unsigned int fuzz_classify(const char *token, size_t *len, size_t *eq) {
+    const char *equals = strchr(token, '=');
+    *len = strlen(token);
+    *eq = equals ? (size_t)(equals - token) : *len;
+    if (token[0] != '-') {
+        return 0;
+    }
+    if (token[1] != '-') {
+        return ARG_TOKEN_DASH;
+    }
+    if (*len == 2) {
+        return ARG_TOKEN_DASH | ARG_TOKEN_LONG | ARG_TOKEN_END;
+    }
+    return ARG_TOKEN_DASH | ARG_TOKEN_LONG | (equals ? ARG_TOKEN_EQ : 0u);
+}
+
+/* Classifies every token at each offset within a 16-byte block, with '=' bytes past its end. */
+static void fuzz_check_classify(const fuzz_case_t *fc) {
+    char *buf = NULL;
+    size_t cap = 0;
+    for (int i = 1; i < fc->argc; i++) {
+        const char *token = fc->tokens[i];
+        size_t size = strlen(token) + 1;
+        if (size + 32 > cap) {
+            cap = size + 32;
+            free(buf);
+            buf = (char *)malloc(cap);
+            if (!buf) {
+                abort();
+            }
+        }
+        size_t expected_len;
+        size_t expected_eq;
+        unsigned int expected = fuzz_classify(token, &expected_len, &expected_eq);
+        for (size_t shift = 0; shift < 16; shift++) {
+            memset(buf, '=', cap);
+            memcpy(buf + shift, token, size);
+            size_t len;
+            size_t eq;
+            unsigned int cls = arg_classify(buf + shift, &len, &eq);
+            if (cls != expected || len != expected_len || eq != expected_eq) {
+                fprintf(stderr, "tinyargs_fuzz: arg_classify(\"%s\") at offset %zu gives class %u, length %zu, '=' at %zu; "
+                        "expected %u, %zu, %zu\n", token, shift, cls, len, eq, expected, expected_len, expected_eq);
+                abort();
+            }
+        }
+    }
+    free(buf);
+}
+
+/*
+ * Naive parser, written from the documented rules rather than from the
+ * library: names are found by scanning the table in registration order, an
+ * abbreviation by counting the distinct long names it starts, and nothing is
+ * reordered; positionals are collected as they are seen. Only the conversion
+ * of a single typed value is the library's own.
+ */
+typedef struct {
+    const arg_t *args;
+    int count;
+    bool dashless;
+    bool *set;
+    const char **values;        /* Latest value of each argument */
+    const char **items;         /* List values in command-line order, with their argument in `item_ids` */
+    int *item_ids;
+    int item_count;
+    const char **positionals;
+    int positional_count;
+    int code;
+    int id;
+} fuzz_oracle_t;
+
+static bool fuzz_oracle_fail(fuzz_oracle_t *o, arg_error_code_t code, int id) {
+    o->code = (int)code;
+    o->id = id;
+    return false;
+}
+
+static bool fuzz_name_is(const char *name, const char *text, size_t len) {
+    return name && strlen(name) == len && memcmp(name, text, len) == 0;
+}
+
+static int fuzz_oracle_find(const fuzz_oracle_t *o, const char *name, size_t len) {
+    for (int i = 0; i < o->count; i++) {
+        if (fuzz_name_is(o->args[i].short_name, name, len) || fuzz_name_is(o->args[i].long_name, name, len)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* The argument whose long name `name` abbreviates, -1 if none, or ARG_PREFIX_AMBIGUOUS if several names start with it. */
+static int fuzz_oracle_abbrev(const fuzz_oracle_t *o, const char *name, size_t len) {
+    int found = -1;
+    for (int i = 0; len > 2 && i < o->count; i++) {
+        const char *long_name = o->args[i].long_name;
+        if (!long_name || strlen(long_name) < len || memcmp(long_name, name, len) != 0) {
+            continue;
+        }
+        if (found < 0) {
+            found = i;
+        } else if (strcmp(o->args[found].long_name, long_name) != 0) {
+            return ARG_PREFIX_AMBIGUOUS;
+        }
+    }
+    return found;
+}
+
+static bool fuzz_oracle_store(fuzz_oracle_t *o, int j, const char *value) {
+    o->values[j] = value;
+    if (o->args[j].type == ARG_TYPE_LIST) {
+        o->items[o->item_count] = value;
+        o->item_ids[o->item_count++] = j;
+    }
+    arg_value_t typed;
+    if (!arg_convert((uint8_t)o->args[j].type, value, &typed)) {
+        return fuzz_oracle_fail(o, ARG_ERROR_INVALID_VALUE, j);
+    }
+    return true;
+}
+
+static int fuzz_oracle_value(fuzz_oracle_t *o, int j, int argc, char **argv, int *i) {
+    if (o->args[j].type == ARG_TYPE_FLAG) {
+        return 1;
+    }
+    if (*i + 1 < argc) {
+        return fuzz_oracle_store(o, j, argv[++*i]);
+    }
+    return o->args[j].required ? fuzz_oracle_fail(o, ARG_ERROR_MISSING_VALUE, j) : 1;
+}
+
+/* 1 if `argv[*i]` is an option, leaving `*i` on its last token; 0 on error; -1 if it is not an option. */
+static int fuzz_oracle_option(fuzz_oracle_t *o, int argc, char **argv, int *i) {
+    const char *token = argv[*i];
+    size_t len = strlen(token);
+    int j = fuzz_oracle_find(o, token, len);
+    if (j >= 0) {
+        o->set[j] = true;
+        return fuzz_oracle_value(o, j, argc, argv, i);
+    }
+    if (token[0] == '-' && token[1] == '-') {
+        const char *equals = strchr(token, '=');
+        size_t name_len = equals ? (size_t)(equals - token) : len;
+        j = equals ? fuzz_oracle_find(o, token, name_len) : -1;
+        if (j < 0) {
+            j = fuzz_oracle_abbrev(o, token, name_len);
+            if (j == ARG_PREFIX_AMBIGUOUS) {
+                return fuzz_oracle_fail(o, ARG_ERROR_AMBIGUOUS, -1);
+            }
+        }
+        if (j < 0) {
+            return -1;
+        }
+        o->set[j] = true;
+        if (!equals) {
+            return fuzz_oracle_value(o, j, argc, argv, i);
+        }
+        if (o->args[j].type == ARG_TYPE_FLAG) {
+            return fuzz_oracle_fail(o, ARG_ERROR_UNEXPECTED_VALUE, j);
+        }
+        return fuzz_oracle_store(o, j, equals + 1);
+    }
+    if (token[0] == '-' && len > 2) {
+        /* A cluster of short names; the first that takes a value takes the rest. */
+        for (size_t pos = 1; pos < len; pos++) {
+            char name[2] = { '-', token[pos] };
+            j = fuzz_oracle_find(o, name, 2);
+            if (j < 0) {
+                return pos == 1 ? -1 : fuzz_oracle_fail(o, ARG_ERROR_UNRECOGNIZED, -1);
+            }
+            o->set[j] = true;
+            if (o->args[j].type != ARG_TYPE_FLAG) {
+                return pos + 1 < len ? fuzz_oracle_store(o, j, token + pos + 1) : fuzz_oracle_value(o, j, argc, argv, i);
+            }
+        }
+        return 1;
+    }
+    return -1;
+}
+
+static int fuzz_oracle_parse(fuzz_oracle_t *o, int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *token = argv[i];
+        if (strcmp(token, "--") == 0) {
+            while (++i < argc) {
+                o->positionals[o->positional_count++] = argv[i];
+            }
+            break;
+        }
+        int status = token[0] == '-' || o->dashless ? fuzz_oracle_option(o, argc, argv, &i) : -1;
+        if (status == 0) {
+            return 0;
+        }
+        if (status > 0) {
+            continue;
+        }
+        if (token[0] == '-' && token[1]) {
+            return fuzz_oracle_fail(o, ARG_ERROR_UNRECOGNIZED, -1);
+        }
+        o->positionals[o->positional_count++] = argv[i];
+    }
+    for (int j = 0; j < o->count; j++) {
+        if (o->args[j].required && !o->set[j]) {
+            return fuzz_oracle_fail(o, ARG_ERROR_MISSING_REQUIRED, j);
+        }
+    }
+    return 1;
+}
+
+/* Renders the oracle's parse like `fuzz_render`, without the error message it has no model of. */
+static void fuzz_oracle_run(fuzz_text_t *out, const arg_t *args, int count, int argc, char **argv) {
+    fuzz_oracle_t o;
+    memset(&o, 0, sizeof(o));
+    o.args = args;
+    o.count = count;
+    o.set = (bool *)calloc((size_t)count + 1, sizeof(bool));
+    o.values = (const char **)calloc((size_t)count + 1, sizeof(char *));
+    o.items = (const char **)malloc(sizeof(char *) * (size_t)argc);
+    o.item_ids = (int *)malloc(sizeof(int) * (size_t)argc);
+    o.positionals = (const char **)malloc(sizeof(char *) * (size_t)argc);
+    if (!o.set || !o.values || !o.items || !o.item_ids || !o.positionals) {
+        abort();
+    }
+    for (int i = 0; i < count; i++) {
+        const char *names[2] = { args[i].short_name, args[i].long_name };
+        for (int k = 0; k < 2; k++) {
+            o.dashless = o.dashless || (names[k] && names[k][0] != '-');
+        }
+    }
+    int ok = fuzz_oracle_parse(&o, argc, argv);
+    out->len = 0;
+    fuzz_printf(out, "ok=%d code=%d id=%d\n", ok, ok ? (int)ARG_ERROR_NONE : o.code, ok ? -1 : o.id);
+    for (int id = 0; ok && id < count; id++) {
+        const char *value = o.values[id];
+        fuzz_printf(out, "%d set=%d value=%s", id, (int)o.set[id], value ? value : "(none)");
+        arg_value_t typed;
+        if (value && arg_convert((uint8_t)args[id].type, value, &typed)) {
+            switch (args[id].type) {
+                case ARG_TYPE_INT: fuzz_printf(out, " int=%lld", (long long)typed.i); break;
+                case ARG_TYPE_DOUBLE: fuzz_printf(out, " double=%a", typed.d); break;
+                case ARG_TYPE_SIZE: fuzz_printf(out, " size=%llu", (unsigned long long)typed.size); break;
+                case ARG_TYPE_DURATION: fuzz_printf(out, " ns=%lld", (long long)typed.ns); break;
+                default: break;
+            }
+        }
+        for (int k = 0; k < o.item_count; k++) {
+            if (o.item_ids[k] == id) {
+                fuzz_printf(out, " [%s]", o.items[k]);
+            }
+        }
+        fuzz_printf(out, "\n");
+    }
+    if (ok) {
+        fuzz_printf(out, "positionals=%d", o.positional_count);
+        for (int k = 0; k < o.positional_count; k++) {
+            fuzz_printf(out, " [%s]", o.positionals[k]);
+        }
+        fuzz_printf(out, "\n");
+    }
+    free(o.set);
+    free(o.values);
+    free(o.items);
+    free(o.item_ids);
+    free(o.positionals);
+}
+
+/* Compares a parser's results, less the error message, with the oracle's on the same table and tokens. */
+static void fuzz_check_oracle(fuzz_text_t *expected, fuzz_text_t *actual, const arg_schema_t *schema, const arg_result_t *result,
+                              int ok, const fuzz_case_t *fc) {
+    fuzz_render(actual, schema, result, ok, "");
+    fuzz_oracle_run(expected, schema->args, schema->count, fc->argc, fc->tokens);
+    if (expected->len != actual->len || memcmp(expected->data, actual->data, expected->len) != 0) {
+        fprintf(stderr, "tinyargs_fuzz: the naive parser disagrees with arg_parser_add\n--- naive\n%.*s--- arg_parser_add\n%.*s",
+                (int)expected->len, expected->data, (int)actual->len, actual->data);
+        abort();
+    }
+}
+
+#ifdef TINYARGS_FUZZ_GEN
+/* The parser generated from fuzz/tinyargs_fuzz.schema, against the same table registered at run time. */
+static void fuzz_run_generated(const fuzz_case_t *fc, fuzz_text_t *reference, fuzz_text_t *actual) {
+    fuzz_gen_args_t args;
+    if (!fuzz_gen_init(&args)) {
+        abort();
+    }
+    arg_parser_set_output(&args.parser, fuzz_discard, NULL);
+    const arg_schema_t *schema = &args.parser.schema;
+    arg_parser_t *dynamic = arg_parser_create();
+    if (!dynamic) {
+        abort();
+    }
+    arg_parser_set_output(dynamic, fuzz_discard, NULL);
+    for (int i = 0; i < schema->count; i++) {
+        const arg_t *arg = &schema->args[i];
+        arg_parser_add(dynamic, arg->short_name, arg->long_name, arg->type, arg->required, arg->description);
+    }
+    char **argv = fuzz_vector(fc);
+    int ok = arg_parser_parse(dynamic, fc->argc, argv);
+    fuzz_render_parser(reference, dynamic, &dynamic->result, ok);
+    char **copy = fuzz_vector(fc);
+    int status = fuzz_gen_parse(&args, fc->argc, copy);
+    fuzz_render_parser(actual, &args.parser, &args.parser.result, status);
+    fuzz_compare("the generated parser", reference, actual);
+
+    /* The fields hold what the accessors return. */
+    arg_parser_t *p = &args.parser;
+    const arg_value_t *jobs = arg_parser_get_typed_id(p, 3);
+    const arg_value_t *ratio = arg_parser_get_typed_id(p, 4);
+    const arg_value_t *limit = arg_parser_get_typed_id(p, 5);
+    const arg_value_t *timeout = arg_parser_get_typed_id(p, 6);
+    int count = 0;
+    const arg_ref_t *include = arg_parser_get_values(p, 7, &count);
+    if (status && (args.verbose != arg_parser_is_set_id(p, 0) || args.version != arg_parser_is_set_id(p, 1) ||
+                   args.name != arg_parser_get_value_id(p, 2) ||
+                   args.has_jobs != (jobs != NULL) || args.jobs != (jobs ? jobs->i : 0) ||
+                   args.has_ratio != (ratio != NULL) || (ratio ? memcmp(&args.ratio, &ratio->d, sizeof(double)) != 0 : args.ratio != 0) ||
+                   args.has_limit != (limit != NULL) || args.limit != (limit ? limit->size : 0) ||
+                   args.has_timeout != (timeout != NULL) || args.timeout != (timeout ? timeout->ns : 0) ||
+                   args.include != include || args.include_count != count || args.run != arg_parser_is_set_id(p, 8) ||
+                   args.positionals.count != arg_parser_get_positionals(p).count)) {
+        fprintf(stderr, "tinyargs_fuzz: a field of the generated parser disagrees with its accessor\n");
+        abort();
+    }
+    fuzz_check_oracle(reference, actual, &dynamic->schema, &dynamic->result, ok, fc);
+    fuzz_gen_free(&args);
+    arg_parser_free(dynamic);
+    free(argv);
+    free(copy);
+}
+#endif
+
+static void fuzz_run(const fuzz_case_t *fc) {
+    fuzz_text_t reference = { NULL, 0, 0 };
+    fuzz_text_t actual = { NULL, 0, 0 };
+
+    /* Reference: a parser built one argument at a time. */
+    arg_parser_t *dynamic = fuzz_build(fc);
+    char **argv = fuzz_vector(fc);
+    int ok = arg_parser_parse(dynamic, fc->argc, argv);
+    fuzz_render_parser(&reference, dynamic, &dynamic->result, ok);
+    const arg_schema_t *frozen = arg_parser_freeze(dynamic);
+    fuzz_check_classify(fc);
+
+    /* A static table. */
+    {
+        arg_parser_t parser;
+        void *state = malloc(ARG_PARSER_STATE_SIZE(fc->count));
+        char **copy = fuzz_vector(fc);
+        if (!state || !arg_parser_init_static(&parser, fc->args, fc->count, state)) {
+            abort();
+        }
+        arg_parser_set_output(&parser, fuzz_discard, NULL);
+        int status = arg_parser_parse(&parser, fc->argc, copy);
+        fuzz_render_parser(&actual, &parser, &parser.result, status);
+        fuzz_compare("arg_parser_init_static", &reference, &actual);
+        arg_parser_free(&parser);
+        free(state);
+        free(copy);
+    }
+
+    /* The reference linear matcher in place of the hash index. */
+    {
+        arg_schema_t schema = *frozen;
+        schema.index = NULL;
+        schema.index_size = 0;
+        schema.lookup = fuzz_linear_lookup;
+        fuzz_linear_schema = frozen;
+        arg_parser_t parser;
+        void *buf = malloc(ARG_RESULT_SIZE(fc->count) + 8);
+        char **copy = fuzz_vector(fc);
+        if (!buf || !arg_parser_init_schema(&parser, &schema, buf)) {
+            abort();
+        }
+        int status = arg_parser_parse(&parser, fc->argc, copy);
+        fuzz_render_parser(&actual, &parser, &parser.result, status);
+        fuzz_compare("a linear lookup matcher", &reference, &actual);
+        arg_parser_free(&parser);
+        free(buf);
+        free(copy);
+    }
+
+#ifdef FUZZ_HAVE_GETPID
+    /* A compiled schema file. */
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/tmp/tinyargs_fuzz_%ld.schema", (long)getpid());
+        arg_parser_t *source = fuzz_build(fc);
+        if (!arg_parser_compile_to(source, path)) {
+            abort();
+        }
+        arg_parser_free(source);
+        arg_parser_t *parser = arg_parser_load_compiled(path);
+        remove(path);
+        if (!parser) {
+            abort();
+        }
+        arg_parser_set_output(parser, fuzz_discard, NULL);
+        char **copy = fuzz_vector(fc);
+        int status = arg_parser_parse(parser, fc->argc, copy);
+        fuzz_render_parser(&actual, parser, &parser->result, status);
+        fuzz_compare("arg_parser_load_compiled", &reference, &actual);
+        arg_parser_free(parser);
+        free(copy);
+    }
+#endif
+
+    /* A batch of one over the frozen schema. */
+    {
+        arg_result_t *result = arg_result_create(frozen);
+        char **copy = fuzz_vector(fc);
+        int argc = fc->argc;
+        if (!result) {
+            abort();
+        }
+        int status = arg_parser_parse_batch(frozen, 1, &argc, &copy, result) == 1;
+        char error[512];
+        arg_result_format_error(frozen, result, error, sizeof(error));
+        fuzz_render(&actual, frozen, result, status, error);
+        fuzz_compare("arg_parser_parse_batch", &reference, &actual);
+        arg_result_free(result);
+        free(copy);
+    }
+
+    /* Tokens fed one at a time, from a scratch buffer so none is kept by reference. */
+    {
+        arg_parser_t *parser = fuzz_build(fc);
+        int status = arg_parser_begin(parser);
+        for (int i = 1; i < fc->argc && status; i++) {
+            size_t len = strlen(fc->tokens[i]);
+            char *scratch = (char *)malloc(len + 1);
+            if (!scratch) {
+                abort();
+            }
+            memcpy(scratch, fc->tokens[i], len);
+            scratch[len] = '#';
+            status = arg_parser_feed(parser, scratch, len);
+            free(scratch);
+        }
+        status = status ? arg_parser_finish(parser) : 0;
+        fuzz_render_parser(&actual, parser, &parser->result, status);
+        fuzz_compare("arg_parser_feed", &reference, &actual);
+        arg_parser_free(parser);
+    }
+
+    /* A wide vector; with ASCII only, narrowing is the identity. */
+    if (fc->ascii) {
+        arg_parser_t *parser = fuzz_build(fc);
+        size_t units = 0;
+        for (int i = 0; i < fc->argc; i++) {
+            units += strlen(fc->tokens[i]) + 1;
+        }
+        /* One pool, so the tokens are in address order and a moved one is found by binary search. */
+        wchar_t *pool = (wchar_t *)malloc(sizeof(wchar_t) * units);
+        wchar_t **wide = (wchar_t **)malloc(sizeof(wchar_t *) * (size_t)fc->argc);
+        wchar_t **wargv = (wchar_t **)malloc(sizeof(wchar_t *) * (size_t)fc->argc);
+        char **narrow = (char **)malloc(sizeof(char *) * (size_t)fc->argc);
+        if (!pool || !wide || !wargv || !narrow) {
+            abort();
+        }
+        wchar_t *next = pool;
+        for (int i = 0; i < fc->argc; i++) {
+            wide[i] = next;
+            for (const char *c = fc->tokens[i]; *c; c++) {
+                *next++ = (wchar_t)*c;
+            }
+            *next++ = L'\0';
+        }
+        memcpy(wargv, wide, sizeof(wchar_t *) * (size_t)fc->argc);
+        int status = arg_parser_parse_w(parser, fc->argc, wargv);
+        /* Render through the narrow accessors: the same tokens, in the order the parse left them. */
+        for (int i = 0; i < fc->argc; i++) {
+            int lo = 0;
+            int hi = fc->argc - 1;
+            while (lo < hi) {
+                int mid = lo + (hi - lo + 1) / 2;
+                if (wide[mid] <= wargv[i]) {
+                    lo = mid;
+                } else {
+                    hi = mid - 1;
+                }
+            }
+            narrow[i] = fc->tokens[lo];
+        }
+        arg_result_t view = parser->result;
+        view.argv = narrow;
+        fuzz_render_parser(&actual, parser, &view, status);
+        fuzz_compare("arg_parser_parse_w", &reference, &actual);
+        arg_parser_free(parser);
+        free(pool);
+        free(wide);
+        free(wargv);
+        free(narrow);
+    }
+
+    fuzz_check_oracle(&reference, &actual, frozen, &dynamic->result, ok, fc);
+#ifdef TINYARGS_FUZZ_GEN
+    fuzz_run_generated(fc, &reference, &actual);
+#endif
+
+    arg_parser_free(dynamic);
+    free(argv);
+    free(reference.data);
+    free(actual.data);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    fuzz_case_t fc;
+    if (fuzz_decode(&fc, data, size)) {
+        fuzz_run(&fc);
+    }
+    fuzz_case_free(&fc);
+    return 0;
+}
+
+#ifndef TINYARGS_FUZZ_LIBFUZZER
+
+static uint8_t* fuzz_read(FILE *file, size_t *size) {
+    size_t cap = 4096;
+    uint8_t *data = (uint8_t *)malloc(cap);
+    *size = 0;
+    while (data) {
+        *size += fread(data + *size, 1, cap - *size, file);
+        if (*size < cap) {
+            break;
+        }
+        cap *= 2;
+        uint8_t *grown = (uint8_t *)realloc(data, cap);
+        if (!grown) {
+            free(data);
+            return NULL;
+        }
+        data = grown;
+    }
+    return data;
+}
+
+static double fuzz_now(void) {
+    struct timespec ts;
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Parses the input with the reference backend for at least `min_time` seconds; returns tokens per second. */
+static double fuzz_bench(const uint8_t *data, size_t size, double min_time, int *tokens, int *ok) {
+    fuzz_case_t fc;
+    double rate = -1;
+    if (fuzz_decode(&fc, data, size)) {
+        arg_parser_t *parser = fuzz_build(&fc);
+        char **argv = fuzz_vector(&fc);
+        long iterations = 0;
+        double start = fuzz_now();
+        double elapsed;
+        do {
+            memcpy(argv, fc.tokens, sizeof(char *) * (size_t)fc.argc);
+            arg_parser_reset(parser);
+            *ok = arg_parser_parse(parser, fc.argc, argv);
+            iterations++;
+            elapsed = fuzz_now() - start;
+        } while (elapsed < min_time);
+        rate = (double)iterations * (double)(fc.argc - 1) / elapsed;
+        *tokens = fc.argc - 1;
+        arg_parser_free(parser);
+        free(argv);
+    }
+    fuzz_case_free(&fc);
+    return rate;
+}
+
+/* xorshift32, so the generated cases are the same on every run. */
+static uint32_t fuzz_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/*
+ * Writes one large-argv case: `options` arguments, every fourth taking a value
+ * and every sixteenth a list, and `tokens` tokens drawn in the given style.
+ */
+static bool fuzz_generate_case(const char *dir, const char *name, int options, int tokens, char style) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        return false;
+    }
+    static const char *const types[] = { "flag", "flag", "flag", "value" };
+    for (int i = 0; i < options; i++) {
+        const char *type = i % 16 == 15 ? "list" : types[i % 4];
+        fprintf(out, "-%c%d --option-%d %s\n", 'a' + i % 26, i / 26, i, type);
+    }
+    fprintf(out, "\n");
+    uint32_t seed = 0x9e3779b9u ^ (uint32_t)(options * 31 + tokens + style);
+    for (int n = 0; n < tokens; n++) {
+        int i = (int)(fuzz_rand(&seed) % (uint32_t)options);
+        bool valued = i % 4 == 3;
+        switch (style) {
+            case 's':
+                fprintf(out, "-%c%d\n", 'a' + i % 26, i / 26);
+                break;
+            case 'k':
+                fprintf(out, valued ? "--option-%d=v%d\n" : "--option-%d\n", i, n);
+                continue;
+            case 'p':
+                if (fuzz_rand(&seed) % 3 == 0) {
+                    fprintf(out, "input-%d.txt\n", n);
+                    continue;
+                }
+                /* fall through */
+            default:
+                fprintf(out, "--option-%d\n", i);
+                break;
+        }
+        if (valued) {
+            fprintf(out, "value-%d\n", n++);
+        }
+    }
+    return fclose(out) == 0;
+}
+
+static bool fuzz_generate(const char *dir) {
+    return fuzz_generate_case(dir, "large-long.txt", 1000, 8192, 'l') &&
+           fuzz_generate_case(dir, "large-short.txt", 1000, 8192, 's') &&
+           fuzz_generate_case(dir, "large-keyvalue.txt", 1000, 8192, 'k') &&
+           fuzz_generate_case(dir, "large-positional.txt", 64, 8192, 'p');
+}
+
+int main(int argc, char *argv[]) {
+    arg_parser_t *cli = arg_parser_create();
+    arg_parser_add(cli, "-h", "--help", ARG_TYPE_FLAG, false, "Show this help");
+    arg_parser_add(cli, "-b", "--bench", ARG_TYPE_FLAG, false, "Time the reference parse of each input and print JSON");
+    arg_parser_add(cli, "-t", "--min-time", ARG_TYPE_DURATION, false, "Minimum time per input with --bench (default 100ms)");
+    arg_parser_add(cli, "-g", "--generate", ARG_TYPE_VALUE, false, "Write the large-argv cases to this directory and exit");
+    if (!arg_parser_parse(cli, argc, argv)) {
+        arg_parser_free(cli);
+        return 2;
+    }
+    if (arg_parser_is_flag_set(cli, "--help")) {
+        arg_parser_print_help(cli);
+        arg_parser_free(cli);
+        return 0;
+    }
+    const char *generate = arg_parser_get_value(cli, "--generate");
+    if (generate) {
+        bool written = fuzz_generate(generate);
+        if (!written) {
+            fprintf(stderr, "tinyargs_fuzz: cannot write to %s\n", generate);
+        }
+        arg_parser_free(cli);
+        return written ? 0 : 1;
+    }
+    bool bench = arg_parser_is_flag_set(cli, "--bench");
+    double min_time = (double)arg_parser_get_duration(cli, "--min-time", 100000000) * 1e-9;
+    arg_span_t inputs = arg_parser_get_positionals(cli);
+
+    int status = 0;
+    if (bench) {
+        printf("{\n  \"benchmark\": \"tinyargs_fuzz\",\n  \"min_time_s\": %g,\n  \"results\": [", min_time);
+    }
+    for (int k = 0; k < (inputs.count ? inputs.count : 1); k++) {
+        const char *path = inputs.count ? inputs.argv[inputs.first + k] : NULL;
+        FILE *file = path ? fopen(path, "rb") : stdin;
+        if (!file) {
+            fprintf(stderr, "tinyargs_fuzz: cannot open %s\n", path);
+            status = 1;
+            continue;
+        }
+        size_t size;
+        uint8_t *data = fuzz_read(file, &size);
+        if (path) {
+            fclose(file);
+        }
+        if (!data) {
+            fprintf(stderr, "tinyargs_fuzz: out of memory\n");
+            status = 1;
+            break;
+        }
+        if (bench) {
+            int tokens = 0;
+            int ok = 0;
+            double rate = fuzz_bench(data, size, min_time, &tokens, &ok);
+            printf("%s\n    {\"input\": \"%s\", \"tokens\": %d, \"ok\": %s, \"parse_tokens_per_sec\": %.0f}",
+                   k ? "," : "", path ? path : "-", tokens, ok ? "true" : "false", rate);
+        } else {
+            LLVMFuzzerTestOneInput(data, size);
+        }
+        free(data);
+    }
+    if (bench) {
+        printf("\n  ]\n}\n");
+    }
+    arg_parser_free(cli);
+    return status;
+}
+
+#endif
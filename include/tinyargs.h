@@ -9,6 +9,13 @@
 #define TINYARGS_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /**
  * @enum arg_type_t
@@ -17,10 +24,25 @@
  * This enumeration defines the types of arguments that can be used:
  * - ARG_TYPE_FLAG: A boolean flag (e.g., `-h` or `--help`).
  * - ARG_TYPE_VALUE: A key-value pair (e.g., `-n name` or `--name=value`).
+ * - ARG_TYPE_INT: A key-value pair holding a signed integer (e.g., `-j 8`, `--offset=0x10`).
+ * - ARG_TYPE_DOUBLE: A key-value pair holding a floating-point number (e.g., `--ratio 0.75`).
+ * - ARG_TYPE_SIZE: A key-value pair holding a byte count with an optional binary
+ *   K, M, G or T suffix (e.g., `--cache 64M`).
+ * - ARG_TYPE_DURATION: A key-value pair holding a duration with an optional ns, us,
+ *   ms, s, m or h suffix, seconds by default (e.g., `--timeout 1.5s`).
+ * - ARG_TYPE_LIST: A key-value pair that may be repeated, keeping every value
+ *   (e.g., `-I include -I src`); see `arg_parser_get_values`.
+ *
+ * Typed values are converted once, during parsing, independently of the C locale.
  */
 typedef enum {
-    ARG_TYPE_FLAG,    /**< A boolean flag */
-    ARG_TYPE_VALUE    /**< A key-value pair */
+    ARG_TYPE_FLAG,     /**< A boolean flag */
+    ARG_TYPE_VALUE,    /**< A key-value pair */
+    ARG_TYPE_INT,      /**< A key-value pair converted to `int64_t` */
+    ARG_TYPE_DOUBLE,   /**< A key-value pair converted to `double` */
+    ARG_TYPE_SIZE,     /**< A key-value pair converted to a byte count */
+    ARG_TYPE_DURATION, /**< A key-value pair converted to nanoseconds */
+    ARG_TYPE_LIST      /**< A repeatable key-value pair */
 } arg_type_t;
 
 /**
@@ -28,28 +50,393 @@ typedef enum {
  * @brief Structure representing an argument.
  *
  * This structure defines an argument including its names, type, and description.
+ * It holds no parse results, so a table of arguments can be declared `static const`
+ * and placed in read-only memory (see `ARG_PARSER_STATIC`).
  */
 typedef struct {
     const char *short_name;     /**< Short name of the argument (e.g., `-h`) */
     const char *long_name;      /**< Long name of the argument (e.g., `--help`) */
     arg_type_t type;            /**< Type of the argument (flag or value) */
     bool required;              /**< Whether the argument is required */
-    bool set;                   /**< Whether the argument has been set */
-    const char *value;          /**< Value associated with the argument (for key-value pairs) */
     const char *description;    /**< Description of the argument */
+    const char *env;            /**< Environment variable supplying a fallback value, or NULL */
 } arg_t;
 
+/**
+ * @brief Stable handle to an argument: its position in registration order.
+ *
+ * Negative values denote an invalid or unknown argument.
+ */
+typedef int arg_id_t;
+
+/**
+ * @struct arg_key_t
+ * @brief Compact copy of the fields of an argument needed while parsing.
+ */
+typedef struct {
+    const char *short_name;     /**< Short name of the argument, or NULL */
+    const char *long_name;      /**< Long name of the argument, or NULL */
+    uint16_t short_len;         /**< Length of `short_name` */
+    uint16_t long_len;          /**< Length of `long_name` */
+    uint8_t type;               /**< Type of the argument, an `arg_type_t` */
+} arg_key_t;
+
+/**
+ * @enum arg_output_t
+ * @brief Kind of text the parser hands to its output sink.
+ */
+typedef enum {
+    ARG_OUTPUT_HELP,   /**< Help text, written to stdout by default */
+    ARG_OUTPUT_ERROR   /**< A parse error message, written to stderr by default */
+} arg_output_t;
+
+/**
+ * @brief Output sink: receives `len` bytes of complete, newline-terminated text.
+ *
+ * Each help listing or error message arrives in a single call.
+ */
+typedef void (*arg_output_fn)(void *ctx, arg_output_t kind, const char *text, size_t len);
+
+/**
+ * @brief Exact-name matcher: the argument named by the first `len` bytes of `name`, or -1.
+ *
+ * `name` need not be NUL-terminated at `len`. Matchers are emitted by
+ * `tinyargs_gen` and replace the name hash index.
+ */
+typedef int (*arg_lookup_fn)(const char *name, size_t len);
+
+/**
+ * @struct arg_schema_t
+ * @brief Structure describing a frozen set of arguments.
+ *
+ * A schema is never modified by parsing, so one schema can be shared by any
+ * number of threads, each parsing into its own `arg_result_t`. Parsing only
+ * touches the dense `keys` array and the `required` bitset; the full `args`
+ * definitions, with their descriptions, are read when printing help. Read
+ * the string fields of `args` and `keys` through `arg_schema_string`.
+ */
+typedef struct {
+    const arg_t *args;   /**< Array of arguments */
+    arg_key_t *keys;     /**< Names and type of each argument, parallel to `args` */
+    uint64_t *required;  /**< Bitset of required arguments */
+    int count;           /**< Number of arguments */
+    int *index;          /**< Open-addressing hash table mapping short and long names to arguments */
+    int index_size;      /**< Number of slots in `index` */
+    int *sorted;         /**< Ids of arguments with a distinct long name, ordered by that name */
+    int sorted_count;    /**< Number of entries in `sorted` */
+    int sorted_for;      /**< Value of `count` when `sorted` was built, or -1 */
+    bool dashless;       /**< Whether any name does not start with '-' */
+    bool lists;          /**< Whether any argument is an `ARG_TYPE_LIST` */
+    bool commands;       /**< Whether the first positional names a subcommand and ends option parsing */
+    arg_output_fn output; /**< Sink for help and error text, or NULL for stdout and stderr */
+    void *output_ctx;    /**< Context passed to `output` */
+    arg_lookup_fn lookup; /**< Matcher used instead of `index`, or NULL */
+    const char *strings; /**< Base the string fields of `args` and `keys` are offsets from, or NULL if they are pointers */
+} arg_schema_t;
+
+/**
+ * @brief Resolve a string field (name, description or variable) of a schema's `args` or `keys`.
+ *
+ * Schemas loaded by `arg_parser_load_compiled` store these fields as offsets
+ * into their string pool, so that the mapped file is used without being
+ * written; every other schema stores the pointers themselves. A NULL field
+ * means the same in both.
+ */
+static inline const char* arg_schema_string(const arg_schema_t *schema, const char *field) {
+    return field ? (const char *)((uintptr_t)schema->strings + (uintptr_t)field) : NULL;
+}
+
+/**
+ * @union arg_value_t
+ * @brief Converted value of a typed argument.
+ */
+typedef union {
+    int64_t i;     /**< Value of an `ARG_TYPE_INT` argument */
+    double d;      /**< Value of an `ARG_TYPE_DOUBLE` argument */
+    uint64_t size; /**< Value of an `ARG_TYPE_SIZE` argument, in bytes */
+    int64_t ns;    /**< Value of an `ARG_TYPE_DURATION` argument, in nanoseconds */
+    struct {
+        int32_t first; /**< Index into the result's `items` of the first value */
+        int32_t count; /**< Number of values */
+    } list;        /**< Values of an `ARG_TYPE_LIST` argument */
+} arg_value_t;
+
+/**
+ * @struct arg_ref_t
+ * @brief Location of an argument's value inside the parsed `argv`.
+ *
+ * For `--name value` the value is a whole token; for `--name=value` and
+ * `-nvalue` it is the tail of the option's own token, so no copy is needed.
+ */
+typedef struct {
+    int index;           /**< Index into `argv` of the token holding the value, or -1 */
+    int offset;          /**< Offset of the value within that token */
+} arg_ref_t;
+
+/**
+ * @struct arg_view_t
+ * @brief Non-owning view of a value inside the parsed `argv`.
+ */
+typedef struct {
+    const char *data;    /**< First character of the value (NUL-terminated), or NULL */
+    size_t len;          /**< Length of the value */
+} arg_view_t;
+
+/**
+ * @struct arg_span_t
+ * @brief Contiguous run of tokens inside the parsed `argv`.
+ *
+ * The tokens are `argv[first]` to `argv[first + count - 1]`; a span can be split
+ * into sub-spans by index alone, without copying any token.
+ */
+typedef struct {
+    char **argv;         /**< Argument vector the span refers to */
+    int first;           /**< Index into `argv` of the first token */
+    int count;           /**< Number of tokens in the span */
+} arg_span_t;
+
+/**
+ * @enum arg_error_code_t
+ * @brief Reason a parse failed.
+ */
+typedef enum {
+    ARG_ERROR_NONE,             /**< Parsing succeeded */
+    ARG_ERROR_UNRECOGNIZED,     /**< A token looks like an option but matches none */
+    ARG_ERROR_AMBIGUOUS,        /**< An abbreviation matches several long names */
+    ARG_ERROR_UNEXPECTED_VALUE, /**< A flag was given a value with `--name=value` */
+    ARG_ERROR_MISSING_VALUE,    /**< A required argument is last and has no value */
+    ARG_ERROR_INVALID_VALUE,    /**< A typed value could not be converted */
+    ARG_ERROR_MISSING_REQUIRED, /**< A required argument was not given */
+    ARG_ERROR_NO_MEMORY,        /**< Storage for list values or response files ran out */
+    ARG_ERROR_UNKNOWN_COMMAND,  /**< The first positional names no registered subcommand */
+    ARG_ERROR_COMMAND_FAILED    /**< A subcommand's parser could not be constructed */
+} arg_error_code_t;
+
+/**
+ * @struct arg_error_t
+ * @brief Description of why a parse failed, cheap enough to record on every failure.
+ *
+ * No message is formatted while parsing; `arg_result_format_error` builds one
+ * from this record on request.
+ */
+typedef struct {
+    arg_error_code_t code;      /**< What went wrong */
+    int index;                  /**< Index into the parsed `argv` of the offending token, or -1 */
+    int offset;                 /**< Offset of the offending value within that token */
+    arg_id_t id;                /**< Argument involved, or -1 */
+} arg_error_t;
+
+struct arg_response;
+struct arg_chunk;
+struct arg_fallback;
+struct arg_commands;
+struct arg_wide;
+struct arg_stream;
+
+/**
+ * @brief Allocation hook: return `size` bytes aligned for any type, or NULL.
+ */
+typedef void* (*arg_alloc_fn)(void *ctx, size_t size);
+
+/**
+ * @brief Deallocation hook: release a block returned by the matching `arg_alloc_fn`.
+ */
+typedef void (*arg_free_fn)(void *ctx, void *ptr);
+
+/**
+ * @struct arg_stats_t
+ * @brief Work done by a parser, collected when the library is built with `TINYARGS_STATS`.
+ *
+ * The counters start from zero with each parse and also take in the lookups
+ * by name and help rendering that follow it, until the next parse.
+ */
+typedef struct {
+    uint64_t tokens;            /**< Tokens classified */
+    uint64_t compares;          /**< Name comparisons, in the hash index and in the sorted index */
+    uint64_t probes;            /**< Hash index slots examined */
+    uint64_t allocations;       /**< Allocations from the parser's arena */
+    uint64_t bytes;             /**< Bytes of those allocations */
+    uint64_t parse_ns;          /**< Time spent parsing, including subcommand dispatch and error reports */
+    uint64_t lookup_ns;         /**< Time spent finding arguments by name in accessors */
+    uint64_t help_ns;           /**< Time spent rendering help */
+} arg_stats_t;
+
+/**
+ * @brief Match hook: called for each option matched while parsing, before its value is read.
+ *
+ * @param ctx Context given to `arg_parser_set_match_hook`.
+ * @param id Handle of the matched argument.
+ * @param index Index into the parsed `argv` of the token naming it.
+ */
+typedef void (*arg_match_fn)(void *ctx, arg_id_t id, int index);
+
+/**
+ * @struct arg_arena_t
+ * @brief Bump allocator holding all memory owned by a parser.
+ */
+typedef struct {
+    arg_alloc_fn alloc;         /**< Hook that provides chunks; malloc when NULL */
+    arg_free_fn free;           /**< Hook that releases chunks; free when NULL */
+    void *ctx;                  /**< Context passed to both hooks */
+    struct arg_chunk *chunks;   /**< Most recent chunk, linked to the earlier ones */
+#ifdef TINYARGS_STATS
+    arg_stats_t *stats;         /**< Counters allocations are added to, or NULL */
+#endif
+} arg_arena_t;
+
+/**
+ * @struct arg_result_t
+ * @brief Structure holding the outcome of parsing one argument vector.
+ *
+ * Values are stored as indices into the parsed `argv`, which must outlive the result.
+ * The values of all `ARG_TYPE_LIST` arguments share the `items` array, where
+ * each argument's values are contiguous and in command-line order. The array
+ * is drawn from `arena` and grows geometrically; its room is reused by later
+ * parses, so a steady parsing loop allocates nothing.
+ */
+typedef struct {
+    arg_value_t *typed;  /**< Converted value of each typed argument, valid once its value is set */
+    uint64_t *set;       /**< Bitset of arguments that have been set */
+    arg_ref_t *values;   /**< Location in `argv` of each argument's value */
+    char **argv;         /**< Argument vector the indices in `values` refer to */
+    int argc;            /**< Number of entries in `argv` */
+    int positional_first; /**< Index into `argv` of the first positional argument */
+    int positional_count; /**< Number of positional arguments */
+    arg_ref_t *items;    /**< Values of list arguments, grouped by argument */
+    int *item_ids;       /**< Argument each entry of `items` was recorded for, in parse order */
+    int item_count;      /**< Number of entries in `items` */
+    int item_capacity;   /**< Number of entries `items` has room for */
+    arg_arena_t *arena;  /**< Source of `items`, or NULL if list values cannot be stored */
+    arg_error_t error;   /**< Why the last parse failed; `ARG_ERROR_NONE` after a success */
+#ifdef TINYARGS_STATS
+    arg_stats_t *stats;  /**< Counters the parse adds to, or NULL */
+    arg_match_fn on_match; /**< Called for each matched option, or NULL */
+    void *match_ctx;     /**< Context passed to `on_match` */
+#endif
+} arg_result_t;
+
+/**
+ * @brief Number of 64-bit words in a bitset covering `n` arguments.
+ */
+#define ARG_BITSET_WORDS(n) (((size_t)(n) + 63) / 64)
+
+/**
+ * @brief Number of name-index slots used for `n` arguments.
+ *
+ * Two names per argument at a load factor of at most 1/2.
+ */
+#define ARG_INDEX_SLOTS(n) ((n) < 4 ? 16 : 4 * (size_t)(n))
+
+/**
+ * @brief Size in bytes of `n` keys, rounded up to keep what follows 8-byte aligned.
+ */
+#define ARG_KEYS_SIZE(n) (((size_t)(n) * sizeof(arg_key_t) + 7) & ~(size_t)7)
+
+/**
+ * @brief Size in bytes of the buffer passed to `arg_result_init`.
+ */
+#define ARG_RESULT_SIZE(n) \
+    ((size_t)(n) * sizeof(arg_value_t) + ARG_BITSET_WORDS(n) * sizeof(uint64_t) + (size_t)(n) * sizeof(arg_ref_t))
+
+/**
+ * @brief Size in bytes of the state buffer passed to `arg_parser_init_static`.
+ *
+ * The buffer holds the dense key array, the required bitset, the parse result,
+ * the name index and the sorted long-name index, in that order.
+ */
+#define ARG_PARSER_STATE_SIZE(n) \
+    (ARG_KEYS_SIZE(n) + ARG_BITSET_WORDS(n) * sizeof(uint64_t) + \
+     ARG_RESULT_SIZE(n) + ARG_INDEX_SLOTS(n) * sizeof(int) + (size_t)(n) * sizeof(int))
+
+/**
+ * @brief Bytes of argument storage a parser needs for `n` arguments.
+ *
+ * Counts the argument table and the state buffer, which is everything that
+ * grows with the schema. Divide by `n` for the per-option footprint.
+ */
+#define ARG_PARSER_FOOTPRINT(n) ((size_t)(n) * sizeof(arg_t) + ARG_PARSER_STATE_SIZE(n))
+
 /**
  * @struct arg_parser_t
  * @brief Structure for the argument parser.
  *
- * This structure holds the arguments and the count of arguments.
+ * This structure holds the schema being built and the result of parsing into it,
+ * so the classic single-threaded API keeps working on one object.
+ *
+ * When `TINYARGS_MAX_ARGS` is defined, the argument table and parse state are
+ * embedded at the end of the structure for that many arguments, so adding
+ * arguments never allocates and parsing never follows a pointer off the parser.
  */
 typedef struct {
-    arg_t *args; /**< Array of arguments */
-    int count;  /**< Number of arguments */
+    arg_schema_t schema; /**< Arguments registered so far and their name index */
+    arg_result_t result; /**< Result of `arg_parser_parse` */
+    int capacity;        /**< Number of arguments the storage has room for */
+    bool is_static;      /**< Whether the storage is borrowed from the caller */
+    bool frozen;         /**< Whether arguments can no longer be added */
+    char **tokens;       /**< Argument vector with response files expanded */
+    int token_capacity;  /**< Number of entries `tokens` has room for */
+    struct arg_response *responses; /**< Response files the expanded tokens point into */
+    struct arg_response *spare_responses; /**< Response files of earlier parses, kept for reuse */
+    bool fallbacks;      /**< Whether any environment binding or config file is set */
+    struct arg_fallback *fallback; /**< Fallback values resolved so far, created on first use */
+    struct arg_commands *commands; /**< Registered subcommands, or NULL */
+    struct arg_response *image; /**< Compiled schema the parser was loaded from, or NULL */
+    wchar_t **wargv;     /**< Vector of the last `arg_parser_parse_w`, or NULL after a narrow parse */
+    struct arg_wide *wide; /**< Wide-encoded names and converted values, created by the first wide parse */
+    struct arg_stream *stream; /**< State of `arg_parser_begin`/`arg_parser_feed`, created by the first stream */
+#ifdef TINYARGS_STATS
+    arg_stats_t stats;   /**< Counters of the last parse and what followed it */
+#endif
+    arg_arena_t arena;   /**< Source of all memory owned by the parser */
+#ifdef TINYARGS_MAX_ARGS
+    bool embedded;       /**< Whether the parser lives in caller storage (`arg_parser_init`) */
+    arg_t inline_args[TINYARGS_MAX_ARGS]; /**< Argument table */
+    uint64_t inline_state[(ARG_PARSER_STATE_SIZE(TINYARGS_MAX_ARGS) + 7) / 8]; /**< Keys, bitsets, result and name index */
+#endif
 } arg_parser_t;
 
+/**
+ * @brief Subcommand constructor: register the subcommand's arguments on `parser`.
+ *
+ * Called at most once per subcommand, the first time it is dispatched to.
+ *
+ * @return 1 on success, 0 if the subcommand cannot be set up.
+ */
+typedef int (*arg_command_fn)(arg_parser_t *parser, void *ctx);
+
+/**
+ * @brief Width in columns that help text is wrapped to.
+ */
+#ifndef ARG_HELP_WIDTH
+#define ARG_HELP_WIDTH 80
+#endif
+
+/**
+ * @brief Declare a static argument table and a matching state buffer.
+ *
+ * Expands to `static const arg_t name_args[]`, initialized from the remaining
+ * macro arguments, and a suitably aligned `name_state` buffer. Pass both to
+ * `arg_parser_init_static`, or use `ARG_PARSER_INIT_STATIC`. Give every field
+ * of each `arg_t`, `env` included, or use designated initializers: a short
+ * initializer warns under `-Wmissing-field-initializers`.
+ *
+ * @code
+ * ARG_PARSER_STATIC(cli,
+ *     { "-h", "--help", ARG_TYPE_FLAG,  false, "Show help",     NULL },
+ *     { "-n", "--name", ARG_TYPE_VALUE, true,  "Name to greet", NULL },
+ *     { .long_name = "--jobs", .type = ARG_TYPE_INT, .description = "Parallel jobs", .env = "APP_JOBS" });
+ * @endcode
+ */
+#define ARG_PARSER_STATIC(name, ...) \
+    static const arg_t name##_args[] = { __VA_ARGS__ }; \
+    static uint64_t name##_state[(ARG_PARSER_STATE_SIZE(sizeof(name##_args) / sizeof(arg_t)) + 7) / 8]
+
+/**
+ * @brief Initialize `parser` from a table declared with `ARG_PARSER_STATIC`.
+ */
+#define ARG_PARSER_INIT_STATIC(parser, name) \
+    arg_parser_init_static((parser), name##_args, (int)(sizeof(name##_args) / sizeof(arg_t)), name##_state)
+
 /**
  * @brief Create a new argument parser.
  *
@@ -57,6 +444,71 @@ typedef struct {
  */
 arg_parser_t* arg_parser_create();
 
+/**
+ * @brief Create a new argument parser drawing its memory from custom hooks.
+ *
+ * The parser and everything it allocates later are bump-allocated from chunks
+ * obtained through `alloc_fn`, which grow geometrically. `arg_parser_free`
+ * hands the chunks back to `free_fn`; nothing is freed individually before that.
+ *
+ * @param alloc_fn Hook that allocates a chunk, or NULL to use malloc.
+ * @param free_fn Hook that releases a chunk, or NULL to use free.
+ * @param ctx Context passed to both hooks.
+ * @return A pointer to the created argument parser, or NULL if allocation failed
+ *         or only one of the hooks was given.
+ */
+arg_parser_t* arg_parser_create_with_allocator(arg_alloc_fn alloc_fn, arg_free_fn free_fn, void *ctx);
+
+/**
+ * @brief Initialize a parser over a caller-owned argument table.
+ *
+ * Performs no heap allocation: the table is used in place and the parse state
+ * and name index are laid out in `state_buf`. Arguments cannot be added to such
+ * a parser. `arg_parser_free` only releases memory allocated while parsing, such
+ * as expanded response files, and leaves the parser and its buffers alone.
+ *
+ * @param parser Pointer to the parser to initialize.
+ * @param table Array of `n` argument definitions; must outlive the parser.
+ * @param n Number of arguments in `table`.
+ * @param state_buf 8-byte aligned buffer of at least `ARG_PARSER_STATE_SIZE(n)` bytes.
+ * @return 1 if the parser was initialized, 0 otherwise.
+ */
+int arg_parser_init_static(arg_parser_t *parser, const arg_t *table, int n, void *state_buf);
+
+/**
+ * @brief Initialize a parser over a schema that is already complete.
+ *
+ * Meant for the constant schemas emitted by `tinyargs_gen`, whose keys, required
+ * bitset, sorted long-name index and matcher are all generated: nothing is
+ * built at run time. The schema's arrays are borrowed and must outlive the
+ * parser, its sorted index must be current (`sorted_for == count`), and it
+ * needs either a name `index` or a `lookup` matcher. The parser is frozen, and
+ * memory it needs later, for response files or list values, comes from the
+ * default allocator until `arg_parser_free`.
+ *
+ * @param parser Pointer to an uninitialized parser.
+ * @param schema Schema to copy; its arrays are not copied.
+ * @param result_buf Buffer of `ARG_RESULT_SIZE(schema->count)` bytes, 8-byte aligned.
+ * @return 1 on success, 0 if the arguments are invalid.
+ */
+int arg_parser_init_schema(arg_parser_t *parser, const arg_schema_t *schema, void *result_buf);
+
+#ifdef TINYARGS_MAX_ARGS
+/**
+ * @brief Initialize a parser in caller storage, with its inline fixed capacity.
+ *
+ * Only available when `TINYARGS_MAX_ARGS` is defined. Up to that many arguments
+ * can be added without any allocation, so a parser in static or stack storage
+ * never touches the heap unless parsing needs memory for response files, list
+ * values or fallbacks. `arg_parser_free` releases only that memory and leaves
+ * the parser alone.
+ *
+ * @param parser Pointer to the parser to initialize.
+ * @return 1 if the parser was initialized, 0 if `parser` is NULL.
+ */
+int arg_parser_init(arg_parser_t *parser);
+#endif
+
 /**
  * @brief Add an argument to the parser.
  *
@@ -66,12 +518,57 @@ arg_parser_t* arg_parser_create();
  * @param type Type of the argument (flag or value).
  * @param required Whether the argument is required.
  * @param description Description of the argument.
+ * @return Handle of the new argument, or -1 if it could not be added (including
+ *         when the `TINYARGS_MAX_ARGS` capacity is full).
  */
-void arg_parser_add(arg_parser_t *parser, const char *short_name, const char *long_name, arg_type_t type, bool required, const char *description);
+arg_id_t arg_parser_add(arg_parser_t *parser, const char *short_name, const char *long_name, arg_type_t type, bool required, const char *description);
+
+/**
+ * @brief Reserve room for at least `n` arguments.
+ *
+ * Registering up to `n` arguments afterwards performs no further allocation.
+ * Without a reservation, `arg_parser_add` grows the storage geometrically.
+ * When `TINYARGS_MAX_ARGS` is defined the storage is the parser's inline
+ * capacity, and reserving more than `TINYARGS_MAX_ARGS` arguments fails.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param n Total number of arguments to make room for.
+ * @return 1 if the storage could be reserved, 0 otherwise.
+ */
+int arg_parser_reserve(arg_parser_t *parser, int n);
 
 /**
  * @brief Parse command-line arguments.
  *
+ * Besides `--name value` and `-n value`, a value may be attached as
+ * `--name=value` or `-nvalue`, and flags with one-letter short names may be
+ * bundled as `-abc`; a value-taking letter ends the bundle and takes the rest of
+ * the token (or the next token) as its value. Attached values are not copied:
+ * they point into the option's own token.
+ *
+ * A long name may be abbreviated to any prefix that no other long name shares
+ * (`--verb` for `--verbose`). An ambiguous prefix is an error listing the
+ * candidates, and an unknown long name reports the closest registered one.
+ *
+ * A token of the form `@path` is replaced by the whitespace-separated tokens
+ * read from the file `path`, which may use single or double quotes and
+ * backslash escapes and may itself contain `@path` tokens. The file is mapped
+ * and tokenized in place; the parser keeps it until the next parse,
+ * `arg_parser_reset` or `arg_parser_free`. A token naming a file that cannot
+ * be read is parsed as an ordinary argument.
+ *
+ * On failure the error is recorded (see `arg_parser_get_error`) and its message
+ * is sent to the output sink. A required argument missing from `argv` is not an
+ * error if its environment variable or the config file provides it.
+ *
+ * A token that is not an option, including a lone `-`, is a positional
+ * argument, and every token after `--` is one. Positionals are gathered into one
+ * contiguous run of the argument vector (see `arg_parser_get_positionals`): as
+ * with GNU getopt, the vector is reordered so that options found after a
+ * positional move in front of it. Positionals keep their relative order.
+ * With subcommands (see `arg_parser_add_command`), the first positional and
+ * every token after it are left to the subcommand instead.
+ *
  * @param parser Pointer to the argument parser.
  * @param argc Argument count.
  * @param argv Array of argument values.
@@ -79,6 +576,188 @@ void arg_parser_add(arg_parser_t *parser, const char *short_name, const char *lo
  */
 int arg_parser_parse(arg_parser_t *parser, int argc, char *argv[]);
 
+/**
+ * @brief Parse a wide-character argument vector, such as the one `wmain` receives.
+ *
+ * Behaves like `arg_parser_parse`, but matches tokens directly against the
+ * argument names, which are encoded as wide strings (UTF-16 or UTF-32, after
+ * the size of `wchar_t`) once, on the first wide parse after the schema
+ * changes; tokens probe the same name index as narrow ones. Nothing is
+ * converted while parsing except typed values, which are narrowed into a
+ * buffer that later parses reuse. Other values are converted to UTF-8 only
+ * when an accessor returns them as `char` strings, into buffers that later
+ * parses reuse; `arg_parser_get_value_w` returns them without any conversion.
+ *
+ * Value locations, list values and positionals index into `argv`, which may
+ * be reordered as in `arg_parser_parse`; offsets count `wchar_t` units, and the
+ * span returned by `arg_parser_get_positionals` has a NULL `argv`. Response files
+ * are not expanded on this path.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param argc Argument count.
+ * @param argv Array of wide argument values; must outlive the parse results.
+ * @return 1 if parsing was successful, 0 otherwise.
+ */
+int arg_parser_parse_w(arg_parser_t *parser, int argc, wchar_t *argv[]);
+
+/**
+ * @brief Get the value of an argument from the last `arg_parser_parse_w`, without conversion.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param id Handle of the argument.
+ * @return Pointer into the wide `argv`, or NULL if the argument has no value there.
+ */
+const wchar_t* arg_parser_get_value_w(arg_parser_t *parser, arg_id_t id);
+
+/**
+ * @brief Start parsing tokens that arrive one at a time.
+ *
+ * Follow with any number of `arg_parser_feed` calls and one `arg_parser_finish`;
+ * together they parse exactly like `arg_parser_parse` on the same tokens, except
+ * that response files are not expanded. The fed tokens stand for `argv[1]`
+ * onward, so no program name is fed.
+ *
+ * @param parser Pointer to the argument parser.
+ * @return 1 on success, 0 if out of memory.
+ */
+int arg_parser_begin(arg_parser_t *parser);
+
+/**
+ * @brief Parse the next token of the stream started by `arg_parser_begin`.
+ *
+ * The token is matched right away, so an unknown option or an invalid value
+ * fails here and is reported as `arg_parser_parse` would; every later call and
+ * `arg_parser_finish` then return 0. The parser keeps a copy only of tokens the
+ * results can refer to (values, positionals and failed tokens), in storage
+ * that later streams reuse, so `token` need not outlive the call. Value
+ * locations index the kept tokens rather than the fed ones.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param token Text of the token; need not be NUL-terminated.
+ * @param len Length of `token` in bytes.
+ * @return 1 if the token was accepted, 0 otherwise.
+ */
+int arg_parser_feed(arg_parser_t *parser, const char *token, size_t len);
+
+/**
+ * @brief End the stream: check for missing values and required arguments, and dispatch subcommands.
+ *
+ * @param parser Pointer to the argument parser.
+ * @return 1 if parsing was successful, 0 otherwise.
+ */
+int arg_parser_finish(arg_parser_t *parser);
+
+#ifdef TINYARGS_STATS
+/**
+ * @brief Get the counters of the last parse (see `arg_stats_t`).
+ *
+ * Without `TINYARGS_STATS`, this is a macro that yields NULL.
+ *
+ * @param parser Pointer to the argument parser.
+ * @return Pointer to the counters, owned by the parser.
+ */
+const arg_stats_t* arg_parser_get_stats(arg_parser_t *parser);
+
+/**
+ * @brief Set the hook called for each option matched by the parser's parses.
+ *
+ * Subcommand parsers keep their own hooks. Without `TINYARGS_STATS`, this is a
+ * macro that does nothing.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param fn Hook to call, or NULL to remove it.
+ * @param ctx Context passed to the hook.
+ */
+void arg_parser_set_match_hook(arg_parser_t *parser, arg_match_fn fn, void *ctx);
+#else
+#define arg_parser_get_stats(parser) ((void)(parser), (const arg_stats_t *)NULL)
+#define arg_parser_set_match_hook(parser, fn, ctx) ((void)(parser), (void)(fn), (void)(ctx))
+#endif
+
+/**
+ * @brief Bind an argument to an environment variable.
+ *
+ * When the argument is not given on the command line, its value is taken from
+ * the variable, and failing that from the config file (see
+ * `arg_parser_load_config`). The variable is only read the first time an
+ * accessor asks for the argument and finds it missing from `argv`. Tables
+ * used with `arg_parser_init_static` set `arg_t.env` instead, and compiled
+ * parsers keep the bindings they were compiled with.
+ *
+ * For a flag, any value other than an empty one, `0`, `false`, `no` or `off`
+ * sets it, and only such a value satisfies a required flag. A typed value that
+ * does not convert is ignored, and the config file is consulted instead.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param id Handle of the argument.
+ * @param name Name of the variable (e.g., `APP_THREADS`); must outlive the parser.
+ * @return 1 if the binding was recorded, 0 otherwise.
+ */
+int arg_parser_bind_env(arg_parser_t *parser, arg_id_t id, const char *name);
+
+/**
+ * @brief Use a config file as the lowest-precedence source of values.
+ *
+ * The file holds `key = value` lines, optionally under INI `[section]` headers;
+ * blank lines and lines starting with `#` or `;` are ignored, and values may be
+ * quoted. An argument's key is its long name without the leading dashes (its
+ * short name if it has none), prefixed by `section.` inside a section; the
+ * last matching line wins.
+ *
+ * The file is mapped, but nothing in it is parsed until an accessor asks for
+ * an argument that `argv` and the environment do not provide, and then only
+ * that argument's key is looked for. Precedence is: command line, environment
+ * variable, config file, the accessor's `fallback`. A later call replaces the
+ * file. List arguments only take values from the command line.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param path Path of the config file.
+ * @return 1 if the file was loaded, 0 if it could not be read.
+ */
+int arg_parser_load_config(arg_parser_t *parser, const char *path);
+
+/**
+ * @brief Register a subcommand (e.g., `build` in `tool build --release`).
+ *
+ * Once a parser has subcommands, option parsing stops at the first positional,
+ * which is looked up by hash among the subcommand names. The matching child
+ * parser is created on first use with the parent's allocator and output sink,
+ * filled in by `build` and frozen; it then parses the rest of the vector, with
+ * the subcommand name as its `argv[0]`. Subcommands that are never used cost
+ * one table entry and are never constructed, and children are kept for later
+ * parses until the parent is freed. A vector without any positional selects
+ * no subcommand and is not an error.
+ *
+ * @param parser Pointer to a parser that is not frozen.
+ * @param name Name of the subcommand; must outlive the parser.
+ * @param build Constructor registering the subcommand's arguments.
+ * @param ctx Context passed to `build`.
+ * @param description Description shown in the help listing, or NULL.
+ * @return 1 if the subcommand was registered, 0 if the parser is frozen, the
+ *         name is taken or memory ran out.
+ */
+int arg_parser_add_command(arg_parser_t *parser, const char *name, arg_command_fn build, void *ctx, const char *description);
+
+/**
+ * @brief Get the subcommand selected by the last parse.
+ *
+ * @param parser Pointer to the argument parser.
+ * @return Name of the subcommand, or NULL if none was given.
+ */
+const char* arg_parser_get_command(arg_parser_t *parser);
+
+/**
+ * @brief Get the parser of the subcommand selected by the last parse.
+ *
+ * Its accessors return the subcommand's own arguments. When the subcommand's
+ * arguments fail to parse, the error is recorded on this parser rather than
+ * on the parent.
+ *
+ * @param parser Pointer to the argument parser.
+ * @return The child parser, or NULL if no subcommand was selected.
+ */
+arg_parser_t* arg_parser_get_command_parser(arg_parser_t *parser);
+
 /**
  * @brief Get the value of an argument.
  *
@@ -97,6 +776,126 @@ const char* arg_parser_get_value(arg_parser_t *parser, const char *name);
  */
 bool arg_parser_is_flag_set(arg_parser_t *parser, const char *name);
 
+/**
+ * @brief Resolve an argument name to its handle.
+ *
+ * Useful with static tables, whose handles are not returned by `arg_parser_add`.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param name Name of the argument (short or long).
+ * @return Handle of the argument, or -1 if no argument has that name.
+ */
+arg_id_t arg_parser_find(arg_parser_t *parser, const char *name);
+
+/**
+ * @brief Get the value of an argument by handle.
+ *
+ * Unlike `arg_parser_get_value`, this performs no name lookup.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param id Handle of the argument.
+ * @return Value of the argument if present, NULL otherwise.
+ */
+const char* arg_parser_get_value_id(arg_parser_t *parser, arg_id_t id);
+
+/**
+ * @brief Get the value of an argument by handle, as a view into `argv`.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param id Handle of the argument.
+ * @return View of the value, with a NULL `data` if the argument has no value.
+ */
+arg_view_t arg_parser_get_view_id(arg_parser_t *parser, arg_id_t id);
+
+/**
+ * @brief Check if an argument is set, by handle.
+ *
+ * Unlike `arg_parser_is_flag_set`, this performs no name lookup.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param id Handle of the argument.
+ * @return true if the argument is set, false otherwise.
+ */
+bool arg_parser_is_set_id(arg_parser_t *parser, arg_id_t id);
+
+/**
+ * @brief Get the converted value of an `ARG_TYPE_INT` argument.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param name Name of the argument (short or long).
+ * @param fallback Value returned when the argument has no value.
+ * @return Converted value of the argument, or `fallback`.
+ */
+int64_t arg_parser_get_int(arg_parser_t *parser, const char *name, int64_t fallback);
+
+/**
+ * @brief Get the converted value of an `ARG_TYPE_DOUBLE` argument.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param name Name of the argument (short or long).
+ * @param fallback Value returned when the argument has no value.
+ * @return Converted value of the argument, or `fallback`.
+ */
+double arg_parser_get_double(arg_parser_t *parser, const char *name, double fallback);
+
+/**
+ * @brief Get the converted value of an `ARG_TYPE_SIZE` argument, in bytes.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param name Name of the argument (short or long).
+ * @param fallback Value returned when the argument has no value.
+ * @return Converted value of the argument, or `fallback`.
+ */
+uint64_t arg_parser_get_size(arg_parser_t *parser, const char *name, uint64_t fallback);
+
+/**
+ * @brief Get the converted value of an `ARG_TYPE_DURATION` argument, in nanoseconds.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param name Name of the argument (short or long).
+ * @param fallback Value returned when the argument has no value.
+ * @return Converted value of the argument, or `fallback`.
+ */
+int64_t arg_parser_get_duration(arg_parser_t *parser, const char *name, int64_t fallback);
+
+/**
+ * @brief Get the converted value of a typed argument, by handle.
+ *
+ * The value is the one converted while parsing, or else the converted value of
+ * the argument's environment or config fallback.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param id Handle of an `ARG_TYPE_INT`, `ARG_TYPE_DOUBLE`, `ARG_TYPE_SIZE` or
+ *           `ARG_TYPE_DURATION` argument.
+ * @return Pointer to the converted value, or NULL if the argument has no value.
+ */
+const arg_value_t* arg_parser_get_typed_id(arg_parser_t *parser, arg_id_t id);
+
+/**
+ * @brief Get every value of an `ARG_TYPE_LIST` argument, by handle.
+ *
+ * The values are in command-line order; each entry locates one value inside
+ * the parsed `argv` (see `arg_result_t`). The array is owned by the parser and
+ * is overwritten by the next parse.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param id Handle of the argument.
+ * @param count Receives the number of values, 0 if there are none.
+ * @return Pointer to the first value, or NULL if the argument has no values.
+ */
+const arg_ref_t* arg_parser_get_values(arg_parser_t *parser, arg_id_t id, int *count);
+
+/**
+ * @brief Get the positional arguments of the last parse.
+ *
+ * When response files were expanded, the span refers to the expanded argument
+ * vector, which the parser owns, rather than to the `argv` passed in.
+ *
+ * @param parser Pointer to the argument parser.
+ * @return Span of the positional arguments, in command-line order.
+ */
+arg_span_t arg_parser_get_positionals(arg_parser_t *parser);
+
 /**
  * @brief Check if an argument is present.
  *
@@ -104,15 +903,64 @@ bool arg_parser_is_flag_set(arg_parser_t *parser, const char *name);
  * @param name Name of the argument (short or long).
  * @return true if the argument is present, false otherwise.
  */
-bool TINYARGS_Has(arg_parser_t *parser, const char *name);
+bool arg_parser_has(arg_parser_t *parser, const char *name);
 
 /**
  * @brief Print help information for the arguments.
  *
+ * The whole listing is rendered into one buffer and handed to the output sink
+ * in a single call (see `arg_parser_format_help`).
+ *
  * @param parser Pointer to the argument parser.
  */
 void arg_parser_print_help(arg_parser_t *parser);
 
+/**
+ * @brief Render help information into a caller-provided buffer.
+ *
+ * Names are aligned in one column and descriptions are word-wrapped to fit
+ * `ARG_HELP_WIDTH` columns. Like `snprintf`, the output is truncated to fit
+ * `size` bytes, is NUL-terminated whenever `size` is non-zero, and the full
+ * length is returned, so a call with a NULL buffer measures the text.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param buf Buffer receiving the text, or NULL if `size` is 0.
+ * @param size Size of `buf` in bytes.
+ * @return Length of the complete help text, excluding the terminator.
+ */
+size_t arg_parser_format_help(arg_parser_t *parser, char *buf, size_t size);
+
+/**
+ * @brief Get the error recorded by the last parse.
+ *
+ * @param parser Pointer to the argument parser.
+ * @return Pointer to the error, whose code is `ARG_ERROR_NONE` after a success.
+ */
+const arg_error_t* arg_parser_get_error(arg_parser_t *parser);
+
+/**
+ * @brief Render the message for the error recorded by the last parse.
+ *
+ * Formats into `buf` with the same conventions as `arg_parser_format_help`.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param buf Buffer receiving the text, or NULL if `size` is 0.
+ * @param size Size of `buf` in bytes.
+ * @return Length of the complete message, excluding the terminator; 0 if there is no error.
+ */
+size_t arg_parser_format_error(arg_parser_t *parser, char *buf, size_t size);
+
+/**
+ * @brief Send help and error text to a custom sink instead of stdio.
+ *
+ * With a sink installed the library performs no I/O of its own.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param output Sink receiving the text, or NULL to restore stdout and stderr.
+ * @param ctx Context passed to `output`.
+ */
+void arg_parser_set_output(arg_parser_t *parser, arg_output_fn output, void *ctx);
+
 /**
  * @brief Free the memory allocated for the parser.
  *
@@ -120,4 +968,421 @@ void arg_parser_print_help(arg_parser_t *parser);
  */
 void arg_parser_free(arg_parser_t *parser);
 
+/**
+ * @brief Forget the outcome of previous parses, keeping every registered argument.
+ *
+ * Successive parses otherwise accumulate flags: a flag set by an earlier call
+ * stays set. Values, list values and positionals always come from the latest
+ * vector, which is where they are located. The reset clears all set bits,
+ * values, list values, positionals and the recorded error with two `memset`
+ * calls over the packed result, and releases response files expanded so far.
+ * It allocates nothing, and neither does the next parse once the parser has
+ * seen vectors of that size, which suits REPL- and server-style loops.
+ * Subcommand parsers built so far are reset too, and no subcommand is
+ * selected until the next parse.
+ *
+ * @param parser Pointer to the argument parser.
+ */
+void arg_parser_reset(arg_parser_t *parser);
+
+/**
+ * @brief Freeze the parser and return its schema.
+ *
+ * After this call no more arguments can be added, and the returned schema may
+ * be shared across threads. It stays valid until the parser is freed. Freezing
+ * builds the sorted long-name index that `arg_schema_parse` uses to resolve
+ * abbreviations.
+ *
+ * @param parser Pointer to the argument parser.
+ * @return Pointer to the parser's schema.
+ */
+const arg_schema_t* arg_parser_freeze(arg_parser_t *parser);
+
+/**
+ * @brief Write the parser's schema to a file that `arg_parser_load_compiled` can map.
+ *
+ * The file holds the argument table, the name hash index, the sorted long-name
+ * index and the rendered help text in one position-independent blob, arranged
+ * for the host it is written on: the native byte order, type sizes and
+ * `ARG_HELP_WIDTH` are baked in. Subcommands, environment values, config files and
+ * output sinks are not part of the schema and cannot be compiled.
+ *
+ * @param parser Pointer to the argument parser.
+ * @param path Path of the file to write.
+ * @return 1 if the file was written, 0 if the parser has subcommands, uses a
+ *         generated matcher or the file could not be written.
+ */
+int arg_parser_compile_to(arg_parser_t *parser, const char *path);
+
+/**
+ * @brief Create a frozen parser from a file written by `arg_parser_compile_to`.
+ *
+ * The file is mapped read-only and used in place: the index is not rebuilt,
+ * nothing is hashed, sorted or copied, and names stay offsets into the
+ * file's string pool (see `arg_schema_string`). Before the parser is
+ * returned, every string offset, index slot and sorted id is checked against
+ * the file, so a damaged file is rejected rather than read out of bounds.
+ * Help is printed from the stored text. The mapping is released by
+ * `arg_parser_free`. Only files written by this library build on the same
+ * kind of host are accepted.
+ *
+ * @param path Path of the compiled file.
+ * @return A pointer to the parser, or NULL if the file cannot be read or was not
+ *         written by a compatible build.
+ */
+arg_parser_t* arg_parser_load_compiled(const char *path);
+
+/**
+ * @brief Create an empty result for parsing against `schema`.
+ *
+ * @param schema Pointer to a frozen schema.
+ * @return A pointer to the created result, or NULL if allocation failed.
+ */
+arg_result_t* arg_result_create(const arg_schema_t *schema);
+
+/**
+ * @brief Initialize an empty result in a caller-provided buffer.
+ *
+ * The result has no arena, so parsing `ARG_TYPE_LIST` values into it fails
+ * unless the caller points `result->arena` at one first.
+ *
+ * @param result Pointer to the result to initialize.
+ * @param schema Pointer to a frozen schema.
+ * @param buf 8-byte aligned buffer of at least `ARG_RESULT_SIZE(schema->count)` bytes.
+ */
+void arg_result_init(arg_result_t *result, const arg_schema_t *schema, void *buf);
+
+/**
+ * @brief Parse command-line arguments against a shared schema.
+ *
+ * Only `result` is written, so several threads may parse against the same
+ * schema at once as long as each uses its own result. Nothing is printed: on
+ * failure the reason is recorded in `result->error`, and formatting a message
+ * is left to `arg_result_format_error`. Value indices always
+ * refer to the `argv` of the most recent call, which may be reordered to make
+ * the positional arguments contiguous (see `arg_parser_parse`).
+ *
+ * @param schema Pointer to a frozen schema.
+ * @param result Pointer to the result to fill.
+ * @param argc Argument count.
+ * @param argv Array of argument values.
+ * @return 1 if parsing was successful, 0 otherwise.
+ */
+int arg_schema_parse(const arg_schema_t *schema, arg_result_t *result, int argc, char *argv[]);
+
+/**
+ * @brief Parse many argument vectors against one shared schema.
+ *
+ * Each `results[k]` is cleared and then filled by parsing `argvs[k]`, exactly
+ * as `arg_schema_parse` would, so failures are recorded in `results[k].error`
+ * without any output. The results must already be initialized (for example
+ * with `arg_result_init` over slices of one large buffer); their previous
+ * contents are discarded, so the same array can be reused batch after batch.
+ *
+ * @param schema Pointer to a frozen schema.
+ * @param n Number of argument vectors.
+ * @param argcs Argument count of each vector.
+ * @param argvs Argument vectors; may be reordered as by `arg_parser_parse`.
+ * @param results Array of `n` initialized results.
+ * @return Number of vectors that parsed successfully.
+ */
+int arg_parser_parse_batch(const arg_schema_t *schema, int n, const int argcs[], char **argvs[], arg_result_t results[]);
+
+/**
+ * @brief Parse many argument vectors, spread over several threads.
+ *
+ * Splits the batch into `threads` contiguous shards, one per thread. Every
+ * vector is parsed independently into its own result, so the results are
+ * identical to those of `arg_parser_parse_batch`. Threads are only used when
+ * the library is built with `TINYARGS_THREADS`; otherwise, or when a thread
+ * cannot be started, the shard is parsed on the calling thread.
+ *
+ * @param schema Pointer to a frozen schema.
+ * @param n Number of argument vectors.
+ * @param argcs Argument count of each vector.
+ * @param argvs Argument vectors; may be reordered as by `arg_parser_parse`.
+ * @param results Array of `n` initialized results.
+ * @param threads Number of threads to use, including the calling one.
+ * @return Number of vectors that parsed successfully.
+ */
+int arg_parser_parse_batch_threads(const arg_schema_t *schema, int n, const int argcs[], char **argvs[], arg_result_t results[], int threads);
+
+/**
+ * @brief Get the value of an argument from a result.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result.
+ * @param name Name of the argument (short or long).
+ * @return Value of the argument if present, NULL otherwise.
+ */
+const char* arg_result_get_value(const arg_schema_t *schema, const arg_result_t *result, const char *name);
+
+/**
+ * @brief Check if an argument was set in a result.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result.
+ * @param name Name of the argument (short or long).
+ * @return true if the argument was set, false otherwise.
+ */
+bool arg_result_is_set(const arg_schema_t *schema, const arg_result_t *result, const char *name);
+
+/**
+ * @brief Get the value of an argument from a result, by handle.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result.
+ * @param id Handle of the argument.
+ * @return Value of the argument if present, NULL otherwise.
+ */
+const char* arg_result_get_value_id(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id);
+
+/**
+ * @brief Get the value of an argument from a result, by handle, as a view into `argv`.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result.
+ * @param id Handle of the argument.
+ * @return View of the value, with a NULL `data` if the argument has no value.
+ */
+arg_view_t arg_result_get_view_id(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id);
+
+/**
+ * @brief Check if an argument was set in a result, by handle.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result.
+ * @param id Handle of the argument.
+ * @return true if the argument was set, false otherwise.
+ */
+bool arg_result_is_set_id(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id);
+
+/**
+ * @brief Get the converted value of a typed argument from a result, by handle.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result.
+ * @param id Handle of an `ARG_TYPE_INT`, `ARG_TYPE_DOUBLE`, `ARG_TYPE_SIZE` or
+ *           `ARG_TYPE_DURATION` argument.
+ * @return Pointer to the converted value, or NULL if the argument has no value.
+ */
+const arg_value_t* arg_result_get_typed_id(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id);
+
+/**
+ * @brief Get every value of an `ARG_TYPE_LIST` argument from a result, by handle.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result.
+ * @param id Handle of the argument.
+ * @param count Receives the number of values, 0 if there are none.
+ * @return Pointer to the first value, or NULL if the argument has no values.
+ */
+const arg_ref_t* arg_result_get_values(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id, int *count);
+
+/**
+ * @brief Render the message for the error recorded in a result.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result, whose `argv` must still be valid.
+ * @param buf Buffer receiving the text, or NULL if `size` is 0.
+ * @param size Size of `buf` in bytes.
+ * @return Length of the complete message, excluding the terminator; 0 if there is no error.
+ */
+size_t arg_result_format_error(const arg_schema_t *schema, const arg_result_t *result, char *buf, size_t size);
+
+/**
+ * @brief Forget the outcome of previous parses into a result.
+ *
+ * @param schema Pointer to the schema the result was parsed against.
+ * @param result Pointer to the result to clear.
+ */
+void arg_result_reset(const arg_schema_t *schema, arg_result_t *result);
+
+/**
+ * @brief Get the positional arguments of a result.
+ *
+ * @param result Pointer to the result.
+ * @return Span of the positional arguments, in command-line order.
+ */
+arg_span_t arg_result_get_positionals(const arg_result_t *result);
+
+/**
+ * @brief Free a result created with `arg_result_create`, including its arena.
+ *
+ * @param result Pointer to the result to be freed.
+ */
+void arg_result_free(arg_result_t *result);
+
+/**
+ * @struct arg_name_t
+ * @brief Argument name with its length and index hash computed ahead of the lookup.
+ *
+ * Built by `ARG_NAME` from a string literal, so the hash is a constant: in C
+ * it is an unrolled expression over the literal's bytes that compilers fold,
+ * and in C++ a `constexpr` function evaluated in a template argument. Names
+ * built at run time use `arg_name_make`. A lookup then only probes.
+ */
+typedef struct {
+    const char *name;    /**< The name, NUL-terminated */
+    size_t len;          /**< Length of `name` */
+    unsigned int hash;   /**< `arg_name_hash(name, len)` */
+} arg_name_t;
+
+/**
+ * @brief Hash of a name in the argument index (FNV-1a).
+ *
+ * Shared with the index itself, which makes precomputed hashes valid for any
+ * parser, including schemas loaded from compiled files.
+ */
+static inline unsigned int arg_name_hash(const char *name, size_t len) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline arg_name_t arg_name_make(const char *name, size_t len) {
+    arg_name_t result;
+    result.name = name;
+    result.len = len;
+    result.hash = arg_name_hash(name, len);
+    return result;
+}
+
+/**
+ * @brief Look up a name with a precomputed hash, inline.
+ *
+ * @return Handle of the argument, or -1 if no argument has that name.
+ */
+static inline arg_id_t arg_schema_find_name(const arg_schema_t *schema, arg_name_t name) {
+    if (schema->lookup) {
+        return schema->lookup(name.name, name.len);
+    }
+    if (!schema->index) {
+        return -1;
+    }
+    unsigned int size = (unsigned int)schema->index_size;
+    for (unsigned int pos = name.hash % size;; pos = pos + 1 == size ? 0 : pos + 1) {
+        int slot = schema->index[pos];
+        if (slot < 0) {
+            return -1;
+        }
+        const arg_key_t *key = &schema->keys[slot >> 1];
+        size_t len = (slot & 1) ? key->long_len : key->short_len;
+        if (len == name.len &&
+            memcmp(arg_schema_string(schema, (slot & 1) ? key->long_name : key->short_name), name.name, len) == 0) {
+            return slot >> 1;
+        }
+    }
+}
+
+/**
+ * @brief Inline counterpart of `arg_parser_find`, taking a prepared name.
+ */
+static inline arg_id_t arg_parser_find_name(arg_parser_t *parser, arg_name_t name) {
+#ifdef TINYARGS_STATS
+    /* Counted lookups stay out of line. */
+    return arg_parser_find(parser, name.name);
+#else
+    return arg_schema_find_name(&parser->schema, name);
+#endif
+}
+
+/**
+ * @brief Inline counterpart of `arg_parser_get_value`, taking a prepared name.
+ *
+ * A narrow parse without environment or config fallbacks is read straight
+ * from the result; anything else goes through `arg_parser_get_value_id`.
+ */
+static inline const char* arg_parser_get_value_name(arg_parser_t *parser, arg_name_t name) {
+    arg_id_t id = arg_parser_find_name(parser, name);
+    if (id < 0) {
+        return NULL;
+    }
+    if (parser->wargv || parser->fallbacks) {
+        return arg_parser_get_value_id(parser, id);
+    }
+    const arg_result_t *result = &parser->result;
+    arg_ref_t ref = result->values[id];
+    return ref.index >= 0 && ref.index < result->argc ? result->argv[ref.index] + ref.offset : NULL;
+}
+
+/**
+ * @brief Inline counterpart of `arg_parser_is_flag_set`, taking a prepared name.
+ */
+static inline bool arg_parser_is_set_name(arg_parser_t *parser, arg_name_t name) {
+    arg_id_t id = arg_parser_find_name(parser, name);
+    if (id < 0) {
+        return false;
+    }
+    if (parser->fallbacks) {
+        return arg_parser_is_set_id(parser, id);
+    }
+    return (parser->result.set[id >> 6] >> (id & 63)) & 1;
+}
+
+#ifdef __cplusplus
+}
+
+/* C++: the hash is forced to a compile-time constant. */
+constexpr unsigned int arg_name_hash_constexpr(const char *name, size_t len, unsigned int hash = 2166136261u) {
+    return len == 0 ? hash : arg_name_hash_constexpr(name + 1, len - 1, (hash ^ (unsigned char)*name) * 16777619u);
+}
+
+template <unsigned int Hash>
+struct arg_name_hash_constant {
+    static constexpr unsigned int value = Hash;
+};
+
+#define ARG_NAME(literal) \
+    (arg_name_t{ "" literal, sizeof(literal) - 1, \
+                 arg_name_hash_constant<arg_name_hash_constexpr("" literal, sizeof(literal) - 1)>::value })
+#else
+/*
+ * C: FNV-1a unrolled over the first ARG_NAME_HASH_MAX bytes of a literal. Steps
+ * past its end xor 0 and multiply by 1, so each one names the running hash
+ * once and the expansion stays linear; compilers fold the whole expression.
+ */
+#define ARG_NAME_HASH_MAX 32
+#define ARG_NAME_BYTE(s, i) ((i) < sizeof(s) - 1 ? (unsigned int)(unsigned char)(s)[(i) < sizeof(s) ? (i) : 0] : 0u)
+#define ARG_NAME_STEP(h, s, i) (((h) ^ ARG_NAME_BYTE(s, i)) * ((i) < sizeof(s) - 1 ? 16777619u : 1u))
+#define ARG_NAME_STEP4(h, s, i) \
+    ARG_NAME_STEP(ARG_NAME_STEP(ARG_NAME_STEP(ARG_NAME_STEP(h, s, i), s, (i) + 1), s, (i) + 2), s, (i) + 3)
+#define ARG_NAME_STEP16(h, s, i) \
+    ARG_NAME_STEP4(ARG_NAME_STEP4(ARG_NAME_STEP4(ARG_NAME_STEP4(h, s, i), s, (i) + 4), s, (i) + 8), s, (i) + 12)
+#define ARG_NAME_HASH(s) \
+    (sizeof(s) - 1 > ARG_NAME_HASH_MAX ? arg_name_hash(s, sizeof(s) - 1) \
+                                       : ARG_NAME_STEP16(ARG_NAME_STEP16(2166136261u, s, 0), s, 16))
+
+static inline arg_name_t arg_name_prepared(const char *name, size_t len, unsigned int hash) {
+    arg_name_t result;
+    result.name = name;
+    result.len = len;
+    result.hash = hash;
+    return result;
+}
+
+/**
+ * @brief Prepared name for a string literal, with its hash computed at compile time.
+ */
+#define ARG_NAME(literal) arg_name_prepared("" literal, sizeof(literal) - 1, ARG_NAME_HASH("" literal))
+#endif
+
+/**
+ * @brief Value of the argument named by a string literal, found by a precomputed hash.
+ */
+#define arg_get(parser, literal) arg_parser_get_value_name((parser), ARG_NAME(literal))
+
+/**
+ * @brief Whether the argument named by a string literal is set, found by a precomputed hash.
+ */
+#define arg_is_set(parser, literal) arg_parser_is_set_name((parser), ARG_NAME(literal))
+
+/**
+ * @brief Handle of the argument named by a string literal, found by a precomputed hash.
+ */
+#define arg_find(parser, literal) arg_parser_find_name((parser), ARG_NAME(literal))
+
 #endif // TINYARGS_H
@@ -0,0 +1,421 @@
+/**
+ * @file tinyargs.hpp
+ * @brief C++20 interface to the argument parser library.
+ *
+ * Wraps `tinyargs.h` in an owning, move-only `tinyargs::parser`, returns values
+ * as `std::string_view` into the parsed `argv`, and builds constant schemas at
+ * compile time with `tinyargs::schema`, whose name index is computed by the
+ * compiler. The C library does all of the parsing.
+ */
+
+#ifndef TINYARGS_HPP
+#define TINYARGS_HPP
+
+#include "tinyargs.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace tinyargs {
+
+/**
+ * @struct option
+ * @brief Definition of one argument, with the fields of `arg_t`.
+ */
+struct option {
+    const char *short_name = nullptr;   /**< Short name (e.g., `-h`), or nullptr */
+    const char *long_name = nullptr;    /**< Long name (e.g., `--help`), or nullptr */
+    arg_type_t type = ARG_TYPE_FLAG;    /**< Type of the argument */
+    bool required = false;              /**< Whether the argument is required */
+    const char *description = "";       /**< Description shown in help */
+    const char *env = nullptr;          /**< Environment variable supplying a fallback, or nullptr */
+};
+
+namespace detail {
+
+/* Not constexpr: reaching one of these while building a schema is a compile error naming the problem. */
+inline void duplicate_option_name() {}
+inline void option_without_name() {}
+inline void option_name_too_long() {}
+inline void unknown_option_name() {}
+
+constexpr std::string_view name_view(const char *name) {
+    return name ? std::string_view(name) : std::string_view();
+}
+
+}  // namespace detail
+
+/**
+ * @class schema
+ * @brief Constant set of `N` arguments, checked and indexed at compile time.
+ *
+ * Holds the argument table, keys, required bitset, hash index and sorted
+ * long-name index in the layout `arg_parser_init_schema` expects, so a parser
+ * over it builds nothing at run time. Duplicate names (including a short name
+ * equal to another argument's long name) and arguments without a name fail to
+ * compile. The schema must outlive every parser using it; declare it
+ * `constexpr` at namespace scope or `static constexpr`.
+ *
+ * @code
+ * static constexpr tinyargs::schema cli{
+ *     tinyargs::option{ "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose output" },
+ *     tinyargs::option{ "-j", "--jobs",    ARG_TYPE_INT,  false, "Parallel jobs" } };
+ * static constexpr arg_id_t jobs = cli.id("--jobs");
+ * @endcode
+ */
+template <std::size_t N>
+class schema {
+public:
+    static constexpr std::size_t size = N;
+    static constexpr std::size_t index_slots = ARG_INDEX_SLOTS(N);
+    static_assert(N <= (std::size_t)std::numeric_limits<int>::max() / 4, "too many options");
+
+    template <class... Options>
+        requires(sizeof...(Options) == N && (std::same_as<Options, option> && ...))
+    consteval explicit schema(const Options &...options) : args_{}, keys_{}, required_{}, index_{}, sorted_{} {
+        const option list[N > 0 ? N : 1] = { options... };
+        for (std::size_t i = 0; i < N; i++) {
+            const option &o = list[i];
+            std::string_view short_name = detail::name_view(o.short_name);
+            std::string_view long_name = detail::name_view(o.long_name);
+            if (short_name.empty() && long_name.empty()) {
+                detail::option_without_name();
+            }
+            if (short_name.size() > UINT16_MAX || long_name.size() > UINT16_MAX) {
+                detail::option_name_too_long();
+            }
+            args_[i] = arg_t{ o.short_name, o.long_name, o.type, o.required, o.description, o.env };
+            keys_[i] = arg_key_t{ o.short_name, o.long_name, (uint16_t)short_name.size(),
+                                  (uint16_t)long_name.size(), (uint8_t)o.type };
+            if ((o.short_name && o.short_name[0] != '-') || (o.long_name && o.long_name[0] != '-')) {
+                dashless_ = true;
+            }
+            if (o.type == ARG_TYPE_LIST) {
+                lists_ = true;
+            }
+            if (o.required) {
+                required_[i >> 6] |= (uint64_t)1 << (i & 63);
+            }
+        }
+        /* Same order as `arg_index_build`: each short name, then each long name, by id. */
+        for (std::size_t k = 0; k < index_slots; k++) {
+            index_[k] = -1;
+        }
+        for (std::size_t i = 0; i < N; i++) {
+            insert((int)(i << 1));
+            insert((int)(i << 1) | 1);
+        }
+        /* Byte-wise order, as `arg_name_cmp`; names are distinct, so ids never tie. */
+        for (std::size_t i = 0; i < N; i++) {
+            if (keys_[i].long_name) {
+                sorted_[sorted_count_++] = (int)i;
+            }
+        }
+        std::sort(sorted_.begin(), sorted_.begin() + sorted_count_, [this](int a, int b) {
+            return long_of(a) < long_of(b);
+        });
+    }
+
+    /**
+     * @brief Handle of the argument called `name`; an unknown name fails to compile.
+     */
+    consteval arg_id_t id(std::string_view name) const {
+        arg_id_t found = find(name);
+        if (found < 0) {
+            detail::unknown_option_name();
+        }
+        return found;
+    }
+
+    /**
+     * @brief Handle of the argument called `name`, or -1, found through the precomputed index.
+     */
+    constexpr arg_id_t find(std::string_view name) const {
+        unsigned int hash = arg_name_hash_constexpr(name.data(), name.size());
+        for (std::size_t pos = hash % index_slots;; pos = pos + 1 == index_slots ? 0 : pos + 1) {
+            int slot = index_[pos];
+            if (slot < 0) {
+                return -1;
+            }
+            if (name_of(slot) == name) {
+                return slot >> 1;
+            }
+        }
+    }
+
+    /**
+     * @brief C view of the schema, for `arg_parser_init_schema` or the `arg_result_*` functions.
+     */
+    arg_schema_t view() const noexcept {
+        arg_schema_t s{};
+        /* Frozen schemas are only read by the library, so the casts never lead to a write. */
+        s.args = args_.data();
+        s.keys = const_cast<arg_key_t *>(keys_.data());
+        s.required = const_cast<uint64_t *>(required_.data());
+        s.count = (int)N;
+        s.index = const_cast<int *>(index_.data());
+        s.index_size = (int)index_slots;
+        s.sorted = const_cast<int *>(sorted_.data());
+        s.sorted_count = sorted_count_;
+        s.sorted_for = (int)N;
+        s.dashless = dashless_;
+        s.lists = lists_;
+        return s;
+    }
+
+private:
+    constexpr std::string_view long_of(int i) const {
+        return std::string_view(keys_[i].long_name, keys_[i].long_len);
+    }
+
+    constexpr std::string_view name_of(int slot) const {
+        const arg_key_t &key = keys_[slot >> 1];
+        return (slot & 1) ? std::string_view(key.long_name, key.long_len)
+                          : std::string_view(key.short_name, key.short_len);
+    }
+
+    constexpr void insert(int slot) {
+        std::string_view name = name_of(slot);
+        if (!name.data()) {
+            return;
+        }
+        unsigned int hash = arg_name_hash_constexpr(name.data(), name.size());
+        for (std::size_t pos = hash % index_slots;; pos = pos + 1 == index_slots ? 0 : pos + 1) {
+            if (index_[pos] < 0) {
+                index_[pos] = slot;
+                return;
+            }
+            if (name_of(index_[pos]) == name) {
+                detail::duplicate_option_name();
+                return;
+            }
+        }
+    }
+
+    std::array<arg_t, N> args_;
+    std::array<arg_key_t, N> keys_;
+    std::array<uint64_t, ARG_BITSET_WORDS(N)> required_;
+    std::array<int, index_slots> index_;
+    std::array<int, N> sorted_;
+    int sorted_count_ = 0;
+    bool dashless_ = false;
+    bool lists_ = false;
+};
+
+template <class... Options>
+schema(const Options &...) -> schema<sizeof...(Options)>;
+
+/**
+ * @class parser
+ * @brief Owning, move-only handle to an `arg_parser_t`.
+ *
+ * Either built up with `add`, like `arg_parser_create`, or frozen over a
+ * `tinyargs::schema`. Values are views into the parsed `argv`, which must
+ * outlive them. A moved-from parser may only be assigned to or destroyed.
+ */
+class parser {
+public:
+    /**
+     * @brief Create an empty parser; throws `std::bad_alloc` if allocation fails.
+     */
+    parser() : parser_(arg_parser_create()) {
+        if (!parser_) {
+            throw std::bad_alloc();
+        }
+    }
+
+    /**
+     * @brief Create a frozen parser over a constant schema, which must outlive it.
+     *
+     * Throws `std::bad_alloc` if allocation fails, or `std::invalid_argument`
+     * if `arg_parser_init_schema` rejects the schema.
+     */
+    template <std::size_t N>
+    explicit parser(const schema<N> &s) {
+        /* The parser and its result buffer share one allocation; the result stays 8-byte aligned. */
+        constexpr std::size_t head = (sizeof(arg_parser_t) + 7) & ~(std::size_t)7;
+        void *storage = ::operator new(head + ARG_RESULT_SIZE(N));
+        arg_schema_t view = s.view();
+        if (!arg_parser_init_schema(static_cast<arg_parser_t *>(storage), &view, static_cast<char *>(storage) + head)) {
+            /* Nothing was set up, so only the storage needs releasing. */
+            ::operator delete(storage);
+            throw std::invalid_argument("tinyargs::parser: schema rejected by arg_parser_init_schema");
+        }
+        parser_ = static_cast<arg_parser_t *>(storage);
+        borrowed_ = true;
+    }
+
+    parser(const parser &) = delete;
+    parser &operator=(const parser &) = delete;
+
+    parser(parser &&other) noexcept
+        : parser_(std::exchange(other.parser_, nullptr)), borrowed_(other.borrowed_) {}
+
+    parser &operator=(parser &&other) noexcept {
+        if (this != &other) {
+            release();
+            parser_ = std::exchange(other.parser_, nullptr);
+            borrowed_ = other.borrowed_;
+        }
+        return *this;
+    }
+
+    ~parser() { release(); }
+
+    /**
+     * @brief Add an argument to a parser that is not frozen.
+     *
+     * @return Handle of the new argument, or -1 if it could not be added.
+     */
+    arg_id_t add(const option &o) {
+        arg_id_t id = arg_parser_add(parser_, o.short_name, o.long_name, o.type, o.required, o.description);
+        if (id >= 0 && o.env) {
+            arg_parser_bind_env(parser_, id, o.env);
+        }
+        return id;
+    }
+
+    /**
+     * @brief Parse an argument vector; see `arg_parser_parse`.
+     */
+    bool parse(int argc, char *argv[]) { return arg_parser_parse(parser_, argc, argv) != 0; }
+
+    /**
+     * @brief Clear the results of earlier parses; see `arg_parser_reset`.
+     */
+    void reset() { arg_parser_reset(parser_); }
+
+    arg_id_t find(const char *name) const { return arg_parser_find(parser_, name); }
+    arg_id_t find(arg_name_t name) const { return arg_parser_find_name(parser_, name); }
+
+    bool is_set(arg_id_t id) const { return arg_parser_is_set_id(parser_, id); }
+    bool is_set(const char *name) const { return is_set(find(name)); }
+    bool is_set(arg_name_t name) const { return is_set(find(name)); }
+
+    /**
+     * @brief Value of an argument as a view into `argv`, or nullopt if it has none.
+     */
+    std::optional<std::string_view> value(arg_id_t id) const {
+        arg_view_t view = arg_parser_get_view_id(parser_, id);
+        if (!view.data) {
+            return std::nullopt;
+        }
+        return std::string_view(view.data, view.len);
+    }
+    std::optional<std::string_view> value(const char *name) const { return value(find(name)); }
+    std::optional<std::string_view> value(arg_name_t name) const { return value(find(name)); }
+
+    /**
+     * @brief Typed value of an argument, read from the conversion done while parsing.
+     *
+     * `bool` reports whether the argument is set and `std::string_view` gives its
+     * text. Signed integers read `ARG_TYPE_INT` arguments, unsigned integers read
+     * `ARG_TYPE_SIZE` or non-negative `ARG_TYPE_INT` arguments, floating-point
+     * types read `ARG_TYPE_DOUBLE` and `std::chrono::duration` types read
+     * `ARG_TYPE_DURATION`. The result is nullopt if the argument has no value, is
+     * of another type, or does not fit in `T`.
+     */
+    template <class T>
+    std::optional<T> get(arg_id_t id) const {
+        if constexpr (std::same_as<T, bool>) {
+            return is_set(id);
+        } else if constexpr (std::same_as<T, std::string_view>) {
+            return value(id);
+        } else {
+            const arg_value_t *typed = arg_parser_get_typed_id(parser_, id);
+            if (!typed) {
+                return std::nullopt;
+            }
+            return convert<T>(parser_->schema.keys[id].type, *typed);
+        }
+    }
+    template <class T>
+    std::optional<T> get(const char *name) const { return get<T>(find(name)); }
+    template <class T>
+    std::optional<T> get(arg_name_t name) const { return get<T>(find(name)); }
+
+    /**
+     * @brief The positional arguments of the last parse, as views into `argv`.
+     */
+    std::span<char *const> positionals() const {
+        arg_span_t span = arg_parser_get_positionals(parser_);
+        if (!span.argv || span.count <= 0) {
+            return {};
+        }
+        return std::span<char *const>(span.argv + span.first, (std::size_t)span.count);
+    }
+
+    /**
+     * @brief Why the last parse failed, formatted as by `arg_parser_format_error`.
+     */
+    std::string error_message() const {
+        std::string text(arg_parser_format_error(parser_, nullptr, 0), '\0');
+        arg_parser_format_error(parser_, text.data(), text.size() + 1);
+        return text;
+    }
+
+    const arg_error_t &error() const { return *arg_parser_get_error(parser_); }
+
+    /**
+     * @brief The underlying C parser, for calls this wrapper does not cover.
+     */
+    arg_parser_t *get() const noexcept { return parser_; }
+
+private:
+    template <class T>
+    static std::optional<T> convert(uint8_t type, const arg_value_t &typed) {
+        if constexpr (std::signed_integral<T>) {
+            if (type == ARG_TYPE_INT && std::in_range<T>(typed.i)) {
+                return (T)typed.i;
+            }
+        } else if constexpr (std::unsigned_integral<T>) {
+            if (type == ARG_TYPE_SIZE && std::in_range<T>(typed.size)) {
+                return (T)typed.size;
+            }
+            if (type == ARG_TYPE_INT && std::in_range<T>(typed.i)) {
+                return (T)typed.i;
+            }
+        } else if constexpr (std::floating_point<T>) {
+            if (type == ARG_TYPE_DOUBLE) {
+                return (T)typed.d;
+            }
+        } else if constexpr (requires { typename T::rep; typename T::period; }) {
+            if (type == ARG_TYPE_DURATION) {
+                return std::chrono::duration_cast<T>(std::chrono::nanoseconds(typed.ns));
+            }
+        } else {
+            static_assert(!sizeof(T), "unsupported type for tinyargs::parser::get");
+        }
+        return std::nullopt;
+    }
+
+    void release() noexcept {
+        if (parser_) {
+            arg_parser_free(parser_);
+            if (borrowed_) {
+                ::operator delete(parser_);
+            }
+            parser_ = nullptr;
+        }
+    }
+
+    arg_parser_t *parser_ = nullptr;
+    bool borrowed_ = false;
+};
+
+}  // namespace tinyargs
+
+#endif  // TINYARGS_HPP
@@ -5,121 +5,3833 @@
  * This file contains the definitions of the functions declared in `tinyargs.h`.
  */
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "tinyargs.h"
+#include <locale.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <wchar.h>
 
-arg_parser_t* arg_parser_create() {
-    arg_parser_t *parser = (arg_parser_t *)malloc(sizeof(arg_parser_t));
-    parser->args = NULL;
-    parser->count = 0;
-    return parser;
+/* Vector token scanning; address sanitizers would flag its aligned over-reads. */
+#if !defined(TINYARGS_NO_SIMD) && !defined(__SANITIZE_ADDRESS__)
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define TINYARGS_NO_SIMD 1
+#endif
+#endif
+#endif
+#if !defined(TINYARGS_NO_SIMD) && !defined(__SANITIZE_ADDRESS__)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TINYARGS_HAVE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TINYARGS_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#ifdef TINYARGS_THREADS
+#include <pthread.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TINYARGS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define ARG_INDEX_EMPTY (-1)
+#define ARG_MIN_CAPACITY 8
+#define ARG_RESPONSE_MAX_DEPTH 16
+
+/*
+ * Fixed capacity. With TINYARGS_MAX_ARGS the argument table and state live
+ * inside the parser; TINYARGS_OPTION_BUDGET, if also set, caps the bytes that
+ * storage may take per option so that a growing layout fails the build.
+ */
+#ifdef TINYARGS_MAX_ARGS
+#if TINYARGS_MAX_ARGS < 1
+#error "TINYARGS_MAX_ARGS must be at least 1"
+#endif
+#ifdef TINYARGS_OPTION_BUDGET
+typedef char arg_option_budget_check[
+    ARG_PARSER_FOOTPRINT(TINYARGS_MAX_ARGS) <= (size_t)TINYARGS_OPTION_BUDGET * TINYARGS_MAX_ARGS ? 1 : -1];
+#endif
+#define ARG_PARSER_EMBEDDED(parser) ((parser)->embedded)
+#else
+#define ARG_PARSER_EMBEDDED(parser) false
+#endif
+
+/*
+ * Instrumentation. With TINYARGS_STATS, work is counted into the `arg_stats_t`
+ * a result or arena points at, and functions that only see the schema take the
+ * counters as an extra parameter. Without it all of this expands to nothing.
+ */
+#ifdef TINYARGS_STATS
+#include <time.h>
+
+#define ARG_STATS_PARAM , arg_stats_t *stats
+#define ARG_STATS_PASS(s) , (s)
+#define ARG_STAT(s, field, n) ((s) ? (void)((s)->field += (n)) : (void)0)
+#define ARG_MATCHED(result, id, index) arg_stats_matched((result), (id), (index))
+#define ARG_TIMER(name) uint64_t name = arg_stats_now()
+#define ARG_TIMER_ADD(s, field, name) ((s)->field += arg_stats_now() - (name))
+#define ARG_STATS_BEGIN(parser) arg_stats_begin(parser)
+
+static uint64_t arg_stats_now(void) {
+    struct timespec ts;
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
 }
 
-void arg_parser_add(arg_parser_t *parser, const char *short_name, const char *long_name, arg_type_t type, bool required, const char *description) {
-    parser->args = (arg_t *)realloc(parser->args, sizeof(arg_t) * (parser->count + 1));
-    parser->args[parser->count].short_name = short_name;
-    parser->args[parser->count].long_name = long_name;
-    parser->args[parser->count].type = type;
-    parser->args[parser->count].required = required;
-    parser->args[parser->count].set = false;
-    parser->args[parser->count].value = NULL;
-    parser->args[parser->count].description = description;
-    parser->count++;
+static void arg_stats_matched(arg_result_t *result, int id, int index) {
+    if (result->on_match) {
+        result->on_match(result->match_ctx, id, index);
+    }
 }
 
-int arg_parser_parse(arg_parser_t *parser, int argc, char *argv[]) {
-    for (int i = 1; i < argc; i++) {
-        bool recognized = false;
-        for (int j = 0; j < parser->count; j++) {
-            arg_t *arg = &parser->args[j];
-
-            if ((arg->short_name && strcmp(argv[i], arg->short_name) == 0) || 
-                (arg->long_name && strcmp(argv[i], arg->long_name) == 0)) {
-                recognized = true;
-                arg->set = true;
-
-                if (arg->type == ARG_TYPE_VALUE) {
-                    if (i + 1 < argc) {
-                        arg->value = argv[++i];
-                    } else if (arg->required) {
-                        printf("Error: Missing value for argument %s\n", argv[i]);
-                        return 0;
-                    }
-                }
-                break;
+/* Starts the counters of a new parse and points the parser's result and arena at them. */
+static void arg_stats_begin(arg_parser_t *parser) {
+    memset(&parser->stats, 0, sizeof(arg_stats_t));
+    parser->result.stats = &parser->stats;
+    parser->arena.stats = &parser->stats;
+}
+#else
+#define ARG_STATS_PARAM
+#define ARG_STATS_PASS(s)
+#define ARG_STAT(s, field, n) ((void)0)
+#define ARG_MATCHED(result, id, index) ((void)0)
+#define ARG_TIMER(name) ((void)0)
+#define ARG_TIMER_ADD(s, field, name) ((void)0)
+#define ARG_STATS_BEGIN(parser) ((void)0)
+#endif
+
+/* A response file loaded for `arg_parser_parse`; the expanded tokens point into `data`. */
+struct arg_response {
+    struct arg_response *next;
+    char *data;
+    size_t mapped;              /* Length of the mapping, or 0 if `data` lives in the arena */
+    char *buffer;               /* Arena buffer files are read into, kept when the response is reused */
+    size_t buffer_cap;          /* Bytes `buffer` has room for */
+};
+
+/*
+ * Arena. Everything a parser owns is bump-allocated from a chain of chunks
+ * obtained from the parser's allocator, and nothing is freed individually:
+ * `arg_parser_free` hands back the chunks and is done. Chunks double in size,
+ * so a parser whose size is known up front (see `arg_parser_reserve`) lives in
+ * one or two of them.
+ */
+
+#define ARG_ARENA_ALIGN 16
+#define ARG_ARENA_CHUNK 4096
+
+struct arg_chunk {
+    struct arg_chunk *next;     /* Previously filled chunk */
+    size_t size;                /* Usable bytes after the header */
+    size_t used;                /* Bytes handed out so far */
+};
+
+#define ARG_ARENA_ROUND(size) (((size) + ARG_ARENA_ALIGN - 1) & ~(size_t)(ARG_ARENA_ALIGN - 1))
+#define ARG_CHUNK_HEADER ARG_ARENA_ROUND(sizeof(struct arg_chunk))
+
+static void* arg_default_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void arg_default_free(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+/* Makes sure the current chunk has `size` free bytes, starting a new one if needed. */
+static bool arg_arena_ensure(arg_arena_t *arena, size_t size) {
+    struct arg_chunk *chunk = arena->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t chunk_size = chunk ? chunk->size * 2 : ARG_ARENA_CHUNK;
+        while (chunk_size < size) {
+            chunk_size *= 2;
+        }
+        if (!arena->alloc) {
+            arena->alloc = arg_default_alloc;
+            arena->free = arg_default_free;
+        }
+        struct arg_chunk *fresh = (struct arg_chunk *)arena->alloc(arena->ctx, ARG_CHUNK_HEADER + chunk_size);
+        if (!fresh) {
+            return false;
+        }
+        fresh->next = chunk;
+        fresh->size = chunk_size;
+        fresh->used = 0;
+        arena->chunks = fresh;
+    }
+    return true;
+}
+
+static void* arg_arena_alloc(arg_arena_t *arena, size_t size) {
+    size = ARG_ARENA_ROUND(size);
+    if (!arg_arena_ensure(arena, size)) {
+        return NULL;
+    }
+    ARG_STAT(arena->stats, allocations, 1);
+    ARG_STAT(arena->stats, bytes, size);
+    struct arg_chunk *chunk = arena->chunks;
+    void *ptr = (char *)chunk + ARG_CHUNK_HEADER + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+/* Grows the most recent allocation in place when it fits, and copies otherwise. */
+static void* arg_arena_realloc(arg_arena_t *arena, void *ptr, size_t old_size, size_t new_size) {
+    struct arg_chunk *chunk = arena->chunks;
+    if (ptr && chunk) {
+        size_t aligned_old = ARG_ARENA_ROUND(old_size);
+        size_t aligned_new = ARG_ARENA_ROUND(new_size);
+        char *top = (char *)chunk + ARG_CHUNK_HEADER + chunk->used;
+        if ((char *)ptr + aligned_old == top && chunk->used - aligned_old + aligned_new <= chunk->size) {
+            chunk->used = chunk->used - aligned_old + aligned_new;
+            return ptr;
+        }
+    }
+    void *fresh = arg_arena_alloc(arena, new_size);
+    if (fresh && ptr) {
+        memcpy(fresh, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return fresh;
+}
+
+static void arg_arena_release(arg_arena_t *arena) {
+    struct arg_chunk *chunk = arena->chunks;
+    while (chunk) {
+        struct arg_chunk *next = chunk->next;
+        arena->free(arena->ctx, chunk);
+        chunk = next;
+    }
+    arena->chunks = NULL;
+}
+
+/*
+ * Text output. Help and error text is assembled in an `arg_text_t` and handed
+ * to the output sink in one call. The buffer starts in caller storage and
+ * moves to the heap when it fills up, unless it is `fixed`, in which case
+ * extra text is dropped but still counted, as with snprintf.
+ */
+
+typedef struct {
+    char *data;
+    size_t len;                 /* Length of the text, including anything dropped */
+    size_t cap;                 /* Bytes `data` has room for, including the terminator */
+    bool heap;                  /* Whether `data` was allocated here */
+    bool fixed;                 /* Whether `data` must not be replaced */
+} arg_text_t;
+
+static void arg_text_init(arg_text_t *text, char *storage, size_t size, bool fixed) {
+    text->data = storage;
+    text->len = 0;
+    text->cap = size;
+    text->heap = false;
+    text->fixed = fixed;
+    if (size) {
+        storage[0] = '\0';
+    }
+}
+
+/* Makes room for `extra` more bytes and a terminator; false if the text must be cut. */
+static bool arg_text_reserve(arg_text_t *text, size_t extra) {
+    if (text->len + extra < text->cap) {
+        return true;
+    }
+    if (text->fixed || text->len >= text->cap) {
+        return false;
+    }
+    size_t cap = text->cap * 2;
+    while (cap <= text->len + extra) {
+        cap *= 2;
+    }
+    char *data = (char *)(text->heap ? realloc(text->data, cap) : malloc(cap));
+    if (!data) {
+        return false;
+    }
+    if (!text->heap) {
+        memcpy(data, text->data, text->len + 1);
+    }
+    text->data = data;
+    text->cap = cap;
+    text->heap = true;
+    return true;
+}
+
+static void arg_text_append(arg_text_t *text, const char *str, size_t len) {
+    if (arg_text_reserve(text, len)) {
+        memcpy(text->data + text->len, str, len);
+        text->data[text->len + len] = '\0';
+    } else if (text->len + 1 < text->cap) {
+        size_t fit = text->cap - text->len - 1;
+        memcpy(text->data + text->len, str, fit);
+        text->data[text->cap - 1] = '\0';
+    }
+    text->len += len;
+}
+
+static void arg_text_pad(arg_text_t *text, size_t n) {
+    static const char spaces[] = "                                ";
+    while (n > 0) {
+        size_t chunk = n < sizeof(spaces) - 1 ? n : sizeof(spaces) - 1;
+        arg_text_append(text, spaces, chunk);
+        n -= chunk;
+    }
+}
+
+static void arg_text_vprintf(arg_text_t *text, const char *fmt, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    size_t room = text->len < text->cap ? text->cap - text->len : 0;
+    int n = vsnprintf(room ? text->data + text->len : NULL, room, fmt, copy);
+    va_end(copy);
+    if (n < 0) {
+        return;
+    }
+    if ((size_t)n >= room && arg_text_reserve(text, (size_t)n)) {
+        vsnprintf(text->data + text->len, (size_t)n + 1, fmt, args);
+    }
+    text->len += (size_t)n;
+}
+
+static void arg_text_printf(arg_text_t *text, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    arg_text_vprintf(text, fmt, args);
+    va_end(args);
+}
+
+static void arg_text_free(arg_text_t *text) {
+    if (text->heap) {
+        free(text->data);
+    }
+}
+
+static void arg_output(const arg_schema_t *schema, arg_output_t kind, const arg_text_t *text) {
+    size_t len = text->len < text->cap ? text->len : (text->cap ? text->cap - 1 : 0);
+    if (schema->output) {
+        schema->output(schema->output_ctx, kind, text->data, len);
+        return;
+    }
+    FILE *stream = kind == ARG_OUTPUT_ERROR ? stderr : stdout;
+    fwrite(text->data, 1, len, stream);
+    fflush(stream);
+}
+
+/*
+ * Slots hold `(arg_index << 1) | is_long`, so a probe compares against exactly
+ * one name, and only when the lengths agree.
+ */
+static bool arg_slot_matches(const arg_schema_t *schema, int slot, const char *name, size_t len) {
+    const arg_key_t *key = &schema->keys[slot >> 1];
+    if (slot & 1) {
+        return key->long_len == len && memcmp(arg_schema_string(schema, key->long_name), name, len) == 0;
+    }
+    return key->short_len == len && memcmp(arg_schema_string(schema, key->short_name), name, len) == 0;
+}
+
+/* Looks up the first `len` bytes of `name`, which need not be NUL-terminated there. */
+static int arg_index_find_n(const arg_schema_t *schema, const char *name, size_t len ARG_STATS_PARAM) {
+    if (schema->lookup) {
+        ARG_STAT(stats, probes, 1);
+        return schema->lookup(name, len);
+    }
+    if (!schema->index) {
+        return -1;
+    }
+    unsigned int size = (unsigned int)schema->index_size;
+    for (unsigned int pos = arg_name_hash(name, len) % size;; pos = pos + 1 == size ? 0 : pos + 1) {
+        int slot = schema->index[pos];
+        ARG_STAT(stats, probes, 1);
+        if (slot == ARG_INDEX_EMPTY) {
+            return -1;
+        }
+        ARG_STAT(stats, compares, 1);
+        if (arg_slot_matches(schema, slot, name, len)) {
+            return slot >> 1;
+        }
+    }
+}
+
+static int arg_index_find(const arg_schema_t *schema, const char *name) {
+    return name ? arg_index_find_n(schema, name, strlen(name) ARG_STATS_PASS(NULL)) : -1;
+}
+
+static void arg_index_insert(arg_schema_t *schema, int slot) {
+    const arg_key_t *key = &schema->keys[slot >> 1];
+    const char *name = (slot & 1) ? key->long_name : key->short_name;
+    size_t len = (slot & 1) ? key->long_len : key->short_len;
+    if (!name) {
+        return;
+    }
+    unsigned int size = (unsigned int)schema->index_size;
+    for (unsigned int pos = arg_name_hash(name, len) % size;; pos = pos + 1 == size ? 0 : pos + 1) {
+        if (schema->index[pos] == ARG_INDEX_EMPTY) {
+            schema->index[pos] = slot;
+            return;
+        }
+        /* The first registration of a name wins, as with the old linear scan. */
+        if (arg_slot_matches(schema, schema->index[pos], name, len)) {
+            return;
+        }
+    }
+}
+
+/* Clears `index` and inserts every registered name into it. */
+static void arg_index_build(arg_schema_t *schema, int *index, int size) {
+    schema->index = index;
+    schema->index_size = size;
+    for (int i = 0; i < size; i++) {
+        schema->index[i] = ARG_INDEX_EMPTY;
+    }
+    for (int i = 0; i < schema->count; i++) {
+        arg_index_insert(schema, i << 1);
+        arg_index_insert(schema, (i << 1) | 1);
+    }
+}
+
+/*
+ * Sorted long-name index. Ids of arguments with a long name, ordered by that
+ * name, so every name sharing a prefix sits in one contiguous run that a
+ * binary search finds. Used for unique-prefix abbreviations (`--verb` for
+ * `--verbose`) and for "did you mean" suggestions; exact matches go through
+ * the hash index.
+ */
+
+static int arg_name_cmp(const char *a, size_t a_len, const char *b, size_t b_len) {
+    int cmp = memcmp(a, b, a_len < b_len ? a_len : b_len);
+    if (cmp) {
+        return cmp;
+    }
+    return a_len < b_len ? -1 : a_len > b_len;
+}
+
+/* Orders by long name, then by id so duplicates keep registration order. */
+static int arg_sorted_cmp(const arg_schema_t *schema, int a, int b) {
+    const arg_key_t *ka = &schema->keys[a];
+    const arg_key_t *kb = &schema->keys[b];
+    int cmp = arg_name_cmp(ka->long_name, ka->long_len, kb->long_name, kb->long_len);
+    return cmp ? cmp : (a > b) - (a < b);
+}
+
+static void arg_sorted_sift(const arg_schema_t *schema, int *ids, int root, int n) {
+    for (int child; (child = 2 * root + 1) < n; root = child) {
+        if (child + 1 < n && arg_sorted_cmp(schema, ids[child], ids[child + 1]) < 0) {
+            child++;
+        }
+        if (arg_sorted_cmp(schema, ids[root], ids[child]) >= 0) {
+            return;
+        }
+        int tmp = ids[root];
+        ids[root] = ids[child];
+        ids[child] = tmp;
+    }
+}
+
+/* Heapsorts in place (no scratch memory, so it also works in static state buffers). */
+static void arg_sorted_build(arg_schema_t *schema) {
+    int *ids = schema->sorted;
+    int n = 0;
+    for (int i = 0; i < schema->count; i++) {
+        if (schema->keys[i].long_name) {
+            ids[n++] = i;
+        }
+    }
+    for (int i = n / 2 - 1; i >= 0; i--) {
+        arg_sorted_sift(schema, ids, i, n);
+    }
+    for (int end = n - 1; end > 0; end--) {
+        int tmp = ids[0];
+        ids[0] = ids[end];
+        ids[end] = tmp;
+        arg_sorted_sift(schema, ids, 0, end);
+    }
+    /* Drop later duplicates of a name; the hash index ignores them too. */
+    int unique = 0;
+    for (int i = 0; i < n; i++) {
+        const arg_key_t *key = &schema->keys[ids[i]];
+        const arg_key_t *prev = unique ? &schema->keys[ids[unique - 1]] : NULL;
+        if (!prev || arg_name_cmp(prev->long_name, prev->long_len, key->long_name, key->long_len) != 0) {
+            ids[unique++] = ids[i];
+        }
+    }
+    schema->sorted_count = unique;
+    schema->sorted_for = schema->count;
+}
+
+/* First position whose long name is not less than `name`. */
+static int arg_sorted_lower_bound(const arg_schema_t *schema, const char *name, size_t len ARG_STATS_PARAM) {
+    int lo = 0;
+    int hi = schema->sorted_count;
+    while (lo < hi) {
+        ARG_STAT(stats, compares, 1);
+        int mid = lo + (hi - lo) / 2;
+        const arg_key_t *key = &schema->keys[schema->sorted[mid]];
+        if (arg_name_cmp(arg_schema_string(schema, key->long_name), key->long_len, name, len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static bool arg_has_prefix(const arg_schema_t *schema, int i, const char *prefix, size_t len) {
+    const arg_key_t *key = &schema->keys[i];
+    return key->long_len >= len && memcmp(arg_schema_string(schema, key->long_name), prefix, len) == 0;
+}
+
+#define ARG_PREFIX_AMBIGUOUS (-2)
+
+/*
+ * Resolves `name` as an abbreviation of a long name. Returns the argument id,
+ * -1 if no long name starts with it, or ARG_PREFIX_AMBIGUOUS with `*first` set
+ * to the start of the run of candidates.
+ */
+static int arg_sorted_find_prefix(const arg_schema_t *schema, const char *name, size_t len, int *first ARG_STATS_PARAM) {
+    if (!schema->sorted || schema->sorted_for != schema->count || len <= 2) {
+        return -1;
+    }
+    int pos = arg_sorted_lower_bound(schema, name, len ARG_STATS_PASS(stats));
+    *first = pos;
+    if (pos == schema->sorted_count) {
+        return -1;
+    }
+    ARG_STAT(stats, compares, 1);
+    if (!arg_has_prefix(schema, schema->sorted[pos], name, len)) {
+        return -1;
+    }
+    if (pos + 1 < schema->sorted_count) {
+        ARG_STAT(stats, compares, 1);
+        if (arg_has_prefix(schema, schema->sorted[pos + 1], name, len)) {
+            return ARG_PREFIX_AMBIGUOUS;
+        }
+    }
+    return schema->sorted[pos];
+}
+
+static size_t arg_common_prefix(const arg_schema_t *schema, int i, const char *name, size_t len) {
+    const arg_key_t *key = &schema->keys[i];
+    const char *long_name = arg_schema_string(schema, key->long_name);
+    size_t n = 0;
+    while (n < key->long_len && n < len && long_name[n] == name[n]) {
+        n++;
+    }
+    return n;
+}
+
+/*
+ * Suggests the long name sharing the longest prefix with `name`. Those are the
+ * neighbors of its insertion point, so no scan is needed. Returns -1 when no
+ * name shares more than the leading `--` and one character.
+ */
+static int arg_sorted_suggest(const arg_schema_t *schema, const char *name, size_t len) {
+    if (!schema->sorted || schema->sorted_for != schema->count || len <= 2) {
+        return -1;
+    }
+    int pos = arg_sorted_lower_bound(schema, name, len ARG_STATS_PASS(NULL));
+    int best = -1;
+    size_t best_len = 3;
+    for (int i = pos - 1; i <= pos; i++) {
+        if (i >= 0 && i < schema->sorted_count) {
+            size_t common = arg_common_prefix(schema, schema->sorted[i], name, len);
+            if (common > best_len) {
+                best = schema->sorted[i];
+                best_len = common;
             }
         }
+    }
+    return best;
+}
 
-        if (!recognized) {
-            printf("Error: Unrecognized argument %s\n", argv[i]);
-            return 0;
+static bool arg_bit_test(const uint64_t *bits, int i) {
+    return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+static void arg_bit_set(uint64_t *bits, int i) {
+    bits[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+static bool arg_name_dashless(const char *name) {
+    return name && name[0] != '-';
+}
+
+static void arg_key_init(arg_key_t *key, const arg_t *arg) {
+    key->short_name = arg->short_name;
+    key->long_name = arg->long_name;
+    key->short_len = (uint16_t)(arg->short_name ? strlen(arg->short_name) : 0);
+    key->long_len = (uint16_t)(arg->long_name ? strlen(arg->long_name) : 0);
+    key->type = (uint8_t)arg->type;
+}
+
+static void arg_error_clear(arg_error_t *error) {
+    error->code = ARG_ERROR_NONE;
+    error->index = -1;
+    error->offset = 0;
+    error->id = -1;
+}
+
+/*
+ * Marks every argument unset; all-ones bytes make every value index -1. Results
+ * are packed as typed values, set bits and value locations (see
+ * `arg_result_init`), so this is two memsets whatever the argument count.
+ */
+static void arg_result_clear(arg_result_t *result, int count) {
+    memset(result->typed, 0, sizeof(arg_value_t) * count + ARG_BITSET_WORDS(count) * sizeof(uint64_t));
+    memset(result->values, 0xff, sizeof(arg_ref_t) * count);
+    result->item_count = 0;
+    arg_error_clear(&result->error);
+    result->argv = NULL;
+    result->argc = 0;
+    result->positional_first = 0;
+    result->positional_count = 0;
+}
+
+/*
+ * Values are located in the vector they were parsed from, so parsing a new
+ * vector forgets those of earlier ones, and its positionals until the scan
+ * finds them; flags set by earlier parses stay set.
+ */
+static void arg_result_forget(const arg_schema_t *schema, arg_result_t *result) {
+    result->positional_first = 0;
+    result->positional_count = 0;
+    size_t words = ARG_BITSET_WORDS(schema->count);
+    for (size_t w = 0; w < words; w++) {
+        uint64_t bits = result->set[w];
+        for (int bit = 0; bits; bit++, bits >>= 1) {
+            int j = (int)(w * 64) + bit;
+            if ((bits & 1) && result->values[j].index >= 0) {
+                result->values[j].index = -1;
+                result->values[j].offset = -1;
+                result->set[w] &= ~((uint64_t)1 << bit);
+            }
         }
     }
+}
 
-    for (int j = 0; j < parser->count; j++) {
-        if (parser->args[j].required && !parser->args[j].set) {
-            printf("Error: Missing required argument %s\n", parser->args[j].long_name);
-            return 0;
+/* Returns the first required argument from `from` on not set in `result`, or -1, a word at a time. */
+static int arg_next_missing(const arg_schema_t *schema, const arg_result_t *result, int from) {
+    size_t words = ARG_BITSET_WORDS(schema->count);
+    for (size_t w = (size_t)from >> 6; w < words; w++) {
+        uint64_t missing = schema->required[w] & ~result->set[w];
+        if (w == (size_t)from >> 6) {
+            missing &= ~(uint64_t)0 << (from & 63);
+        }
+        if (missing) {
+            int bit = 0;
+            while (!(missing & 1)) {
+                missing >>= 1;
+                bit++;
+            }
+            return (int)(w * 64) + bit;
         }
     }
+    return -1;
+}
 
-    return 1;
+static bool arg_result_has_value(const arg_result_t *result, int i) {
+    return result->values[i].index >= 0 && result->values[i].index < result->argc;
 }
 
-const char* arg_parser_get_value(arg_parser_t *parser, const char *name) {
-    for (int i = 0; i < parser->count; i++) {
-        if ((parser->args[i].short_name && strcmp(parser->args[i].short_name, name) == 0) || 
-            (parser->args[i].long_name && strcmp(parser->args[i].long_name, name) == 0)) {
-            return parser->args[i].value;
+static const char* arg_result_value_at(const arg_result_t *result, int i) {
+    arg_ref_t ref = result->values[i];
+    return arg_result_has_value(result, i) ? result->argv[ref.index] + ref.offset : NULL;
+}
+
+/*
+ * Typed value conversion. Integers and the common decimal forms are parsed by
+ * hand so results never depend on the C locale; only doubles that cannot be
+ * converted exactly fall back to strtod.
+ */
+
+static const double arg_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static bool arg_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/* Parses a decimal or `0x`-prefixed hexadecimal magnitude, leaving `*end` after it. */
+static bool arg_parse_u64(const char *text, const char **end, uint64_t *out) {
+    uint64_t value = 0;
+    unsigned int base = 10;
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+    }
+    const char *start = text;
+    for (;; text++) {
+        unsigned int digit;
+        if (arg_is_digit(*text)) {
+            digit = (unsigned int)(*text - '0');
+        } else if (base == 16 && *text >= 'a' && *text <= 'f') {
+            digit = (unsigned int)(*text - 'a' + 10);
+        } else if (base == 16 && *text >= 'A' && *text <= 'F') {
+            digit = (unsigned int)(*text - 'A' + 10);
+        } else {
+            break;
         }
+        if (value > (UINT64_MAX - digit) / base) {
+            return false;
+        }
+        value = value * base + digit;
     }
-    return NULL;
+    if (text == start) {
+        return false;
+    }
+    *end = text;
+    *out = value;
+    return true;
 }
 
-bool arg_parser_is_flag_set(arg_parser_t *parser, const char *name) {
-    for (int i = 0; i < parser->count; i++) {
-        if ((parser->args[i].short_name && strcmp(parser->args[i].short_name, name) == 0) || 
-            (parser->args[i].long_name && strcmp(parser->args[i].long_name, name) == 0)) {
-            return parser->args[i].set;
+static bool arg_convert_int(const char *text, int64_t *out) {
+    bool negative = *text == '-';
+    if (*text == '-' || *text == '+') {
+        text++;
+    }
+    const char *end;
+    uint64_t magnitude;
+    if (!arg_parse_u64(text, &end, &magnitude) || *end) {
+        return false;
+    }
+    if (magnitude > (uint64_t)INT64_MAX + negative) {
+        return false;
+    }
+    *out = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return true;
+}
+
+/* strtod on a copy whose '.' is replaced by the current locale's decimal point. */
+static bool arg_convert_double_slow(const char *text, double *out) {
+    if (!*text || *text == ' ' || (*text >= '\t' && *text <= '\r')) {
+        return false;
+    }
+    const char *point = localeconv()->decimal_point;
+    size_t point_len = strlen(point);
+    size_t len = strlen(text);
+    char stack[128];
+    char *buf = len + point_len < sizeof(stack) ? stack : (char *)malloc(len + point_len + 1);
+    if (!buf) {
+        return false;
+    }
+    char *dst = buf;
+    for (const char *src = text; *src; src++) {
+        if (*src == '.') {
+            memcpy(dst, point, point_len);
+            dst += point_len;
+        } else {
+            *dst++ = *src;
         }
     }
-    return false;
+    *dst = '\0';
+    char *end;
+    *out = strtod(buf, &end);
+    bool ok = end != buf && *end == '\0';
+    if (buf != stack) {
+        free(buf);
+    }
+    return ok;
 }
 
-bool arg_parser_has(arg_parser_t *parser, const char *name) {
-    for (int i = 0; i < parser->count; i++) {
-        if ((parser->args[i].short_name && strcmp(parser->args[i].short_name, name) == 0) || 
-            (parser->args[i].long_name && strcmp(parser->args[i].long_name, name) == 0)) {
-            if (parser->args[i].type == ARG_TYPE_FLAG) {
-                return parser->args[i].set;
-            } else if (parser->args[i].type == ARG_TYPE_VALUE) {
-                return parser->args[i].value != NULL;
+/* Exact when the significand fits in 53 bits and the power of ten is exactly representable. */
+static bool arg_convert_double(const char *text, double *out) {
+    const char *p = text;
+    bool negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool any = false;
+    for (; arg_is_digit(*p); p++) {
+        any = true;
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        digits += mantissa != 0;
+        if (digits > 19) {
+            return arg_convert_double_slow(text, out);
+        }
+    }
+    if (*p == '.') {
+        for (p++; arg_is_digit(*p); p++) {
+            any = true;
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += mantissa != 0;
+            exp10--;
+            if (digits > 19) {
+                return arg_convert_double_slow(text, out);
             }
         }
     }
-    return false;
+    if (any && (*p == 'e' || *p == 'E')) {
+        const char *exp_start = p++;
+        bool exp_negative = *p == '-';
+        if (*p == '-' || *p == '+') {
+            p++;
+        }
+        int exp = 0;
+        if (!arg_is_digit(*p)) {
+            p = exp_start;
+        }
+        for (; arg_is_digit(*p); p++) {
+            if (exp < 10000) {
+                exp = exp * 10 + (*p - '0');
+            }
+        }
+        exp10 += exp_negative ? -exp : exp;
+    }
+    if (!any || *p || mantissa > ((uint64_t)1 << 53) || exp10 < -22 || exp10 > 22) {
+        return arg_convert_double_slow(text, out);
+    }
+    double value = (double)mantissa;
+    value = exp10 < 0 ? value / arg_pow10[-exp10] : value * arg_pow10[exp10];
+    *out = negative ? -value : value;
+    return true;
 }
 
-void arg_parser_print_help(arg_parser_t *parser) {
-    printf("Usage:\n");
-    for (int i = 0; i < parser->count; i++) {
-        arg_t *arg = &parser->args[i];
-        const char *type_str = (arg->type == ARG_TYPE_FLAG) ? "Flag" : "Key=Value";
-        if (arg->short_name && arg->long_name) {
-            printf("  %s, %s: %s (Type: %s)\n", arg->short_name, arg->long_name, arg->description, type_str);
-        } else if (arg->short_name) {
-            printf("  %s:     %s (Type: %s)\n", arg->short_name, arg->description, type_str);
-        } else if (arg->long_name) {
-            printf("  %s:     %s (Type: %s)\n", arg->long_name, arg->description, type_str);
+static bool arg_convert_size(const char *text, uint64_t *out) {
+    const char *end;
+    uint64_t value;
+    if (!arg_parse_u64(text, &end, &value)) {
+        return false;
+    }
+    unsigned int shift = 0;
+    switch (*end) {
+        case 'K': case 'k': shift = 10; break;
+        case 'M': case 'm': shift = 20; break;
+        case 'G': case 'g': shift = 30; break;
+        case 'T': case 't': shift = 40; break;
+        default: break;
+    }
+    if (shift) {
+        end++;
+        if (*end == 'i') {
+            end++;
         }
     }
+    if (*end == 'B' || *end == 'b') {
+        end++;
+    }
+    if (*end || value > (UINT64_MAX >> shift)) {
+        return false;
+    }
+    *out = value << shift;
+    return true;
 }
 
-void arg_parser_free(arg_parser_t *parser) {
+static bool arg_convert_duration(const char *text, int64_t *out) {
+    uint64_t whole = 0;
+    uint64_t frac = 0;
+    int frac_digits = 0;
+    const char *p = text;
+    if (!arg_is_digit(*p)) {
+        return false;
+    }
+    for (; arg_is_digit(*p); p++) {
+        if (whole > (UINT64_MAX - 9) / 10) {
+            return false;
+        }
+        whole = whole * 10 + (uint64_t)(*p - '0');
+    }
+    if (*p == '.') {
+        for (p++; arg_is_digit(*p); p++) {
+            if (frac_digits < 18) {
+                frac = frac * 10 + (uint64_t)(*p - '0');
+                frac_digits++;
+            }
+        }
+    }
+    uint64_t unit;
+    if (strcmp(p, "ns") == 0) {
+        unit = 1;
+    } else if (strcmp(p, "us") == 0) {
+        unit = 1000;
+    } else if (strcmp(p, "ms") == 0) {
+        unit = 1000000;
+    } else if (*p == '\0' || strcmp(p, "s") == 0) {
+        unit = 1000000000;
+    } else if (strcmp(p, "m") == 0) {
+        unit = 60 * (uint64_t)1000000000;
+    } else if (strcmp(p, "h") == 0) {
+        unit = 3600 * (uint64_t)1000000000;
+    } else {
+        return false;
+    }
+    if (whole > (uint64_t)INT64_MAX / unit) {
+        return false;
+    }
+    uint64_t ns = whole * unit + (uint64_t)((double)frac * (double)unit / arg_pow10[frac_digits] + 0.5);
+    if (ns > (uint64_t)INT64_MAX) {
+        return false;
+    }
+    *out = (int64_t)ns;
+    return true;
+}
+
+static bool arg_convert(uint8_t type, const char *text, arg_value_t *out) {
+    switch (type) {
+        case ARG_TYPE_INT: return arg_convert_int(text, &out->i);
+        case ARG_TYPE_DOUBLE: return arg_convert_double(text, &out->d);
+        case ARG_TYPE_SIZE: return arg_convert_size(text, &out->size);
+        case ARG_TYPE_DURATION: return arg_convert_duration(text, &out->ns);
+        default: return true;
+    }
+}
+
+arg_parser_t* arg_parser_create() {
+    return arg_parser_create_with_allocator(NULL, NULL, NULL);
+}
+
+arg_parser_t* arg_parser_create_with_allocator(arg_alloc_fn alloc_fn, arg_free_fn free_fn, void *ctx) {
+    if (!alloc_fn != !free_fn) {
+        return NULL;
+    }
+    arg_arena_t arena;
+    memset(&arena, 0, sizeof(arg_arena_t));
+    arena.alloc = alloc_fn;
+    arena.free = free_fn;
+    arena.ctx = ctx;
+    /* The parser itself is the first thing in the arena. */
+    arg_parser_t *parser = (arg_parser_t *)arg_arena_alloc(&arena, sizeof(arg_parser_t));
     if (parser) {
-        free(parser->args);
-        free(parser);
+        memset(parser, 0, sizeof(arg_parser_t));
+        parser->arena = arena;
+        parser->result.arena = &parser->arena;
+    }
+    return parser;
+}
+
+int arg_parser_init_static(arg_parser_t *parser, const arg_t *table, int n, void *state_buf) {
+    if (!parser || (n > 0 && (!table || !state_buf)) || n < 0) {
+        return 0;
+    }
+    memset(parser, 0, sizeof(arg_parser_t));
+    char *buf = (char *)state_buf;
+    parser->schema.args = table;
+    parser->schema.keys = (arg_key_t *)buf;
+    buf += ARG_KEYS_SIZE(n);
+    parser->schema.required = (uint64_t *)buf;
+    buf += ARG_BITSET_WORDS(n) * sizeof(uint64_t);
+    parser->schema.count = n;
+    parser->capacity = n;
+    parser->is_static = true;
+    parser->frozen = true;
+    memset(parser->schema.required, 0, ARG_BITSET_WORDS(n) * sizeof(uint64_t));
+    for (int i = 0; i < n; i++) {
+        arg_key_init(&parser->schema.keys[i], &table[i]);
+        if (arg_name_dashless(table[i].short_name) || arg_name_dashless(table[i].long_name)) {
+            parser->schema.dashless = true;
+        }
+        if (table[i].type == ARG_TYPE_LIST) {
+            parser->schema.lists = true;
+        }
+        if (table[i].env) {
+            parser->fallbacks = true;
+        }
+        if (table[i].required) {
+            arg_bit_set(parser->schema.required, i);
+        }
+    }
+    arg_result_init(&parser->result, &parser->schema, buf);
+    parser->result.arena = &parser->arena;
+    buf += ARG_RESULT_SIZE(n);
+    arg_index_build(&parser->schema, (int *)buf, (int)ARG_INDEX_SLOTS(n));
+    buf += ARG_INDEX_SLOTS(n) * sizeof(int);
+    parser->schema.sorted = (int *)buf;
+    arg_sorted_build(&parser->schema);
+    return 1;
+}
+
+int arg_parser_init_schema(arg_parser_t *parser, const arg_schema_t *schema, void *result_buf) {
+    if (!parser || !schema || schema->count < 0 || (schema->count > 0 && !result_buf) ||
+        (!schema->index && !schema->lookup) || schema->sorted_for != schema->count) {
+        return 0;
+    }
+    memset(parser, 0, sizeof(arg_parser_t));
+    parser->schema = *schema;
+    parser->capacity = schema->count;
+    parser->is_static = true;
+    parser->frozen = true;
+    for (int i = 0; i < schema->count; i++) {
+        if (schema->args[i].env) {
+            parser->fallbacks = true;
+        }
+    }
+    arg_result_init(&parser->result, &parser->schema, result_buf);
+    parser->result.arena = &parser->arena;
+    return 1;
+}
+
+#ifdef TINYARGS_MAX_ARGS
+/* Lays the schema and result out in the parser's inline storage, in the order of `ARG_PARSER_STATE_SIZE`. */
+static void arg_parser_bind_inline(arg_parser_t *parser) {
+    const int n = TINYARGS_MAX_ARGS;
+    size_t words = ARG_BITSET_WORDS(n);
+    char *buf = (char *)parser->inline_state;
+    parser->schema.args = parser->inline_args;
+    parser->schema.keys = (arg_key_t *)buf;
+    buf += ARG_KEYS_SIZE(n);
+    parser->schema.required = (uint64_t *)buf;
+    memset(parser->schema.required, 0, words * sizeof(uint64_t));
+    buf += words * sizeof(uint64_t);
+    /* `arg_result_init` would size the result by `count`, which is still zero. */
+    parser->result.typed = (arg_value_t *)buf;
+    parser->result.set = (uint64_t *)(parser->result.typed + n);
+    parser->result.values = (arg_ref_t *)(parser->result.set + words);
+    memset(parser->result.set, 0, words * sizeof(uint64_t));
+    buf += ARG_RESULT_SIZE(n);
+    arg_index_build(&parser->schema, (int *)buf, (int)ARG_INDEX_SLOTS(n));
+    buf += ARG_INDEX_SLOTS(n) * sizeof(int);
+    parser->schema.sorted = (int *)buf;
+    parser->schema.sorted_for = -1;
+    parser->capacity = n;
+}
+
+int arg_parser_init(arg_parser_t *parser) {
+    if (!parser) {
+        return 0;
+    }
+    memset(parser, 0, sizeof(arg_parser_t));
+    parser->embedded = true;
+    parser->result.arena = &parser->arena;
+    arg_parser_bind_inline(parser);
+    return 1;
+}
+#endif
+
+int arg_parser_reserve(arg_parser_t *parser, int n) {
+    if (n <= parser->capacity) {
+        return 1;
+    }
+    if (parser->frozen) {
+        return 0;
+    }
+#ifdef TINYARGS_MAX_ARGS
+    /* The inline storage is bound once and never moves or grows. */
+    if (n > TINYARGS_MAX_ARGS || parser->capacity) {
+        return 0;
+    }
+    arg_parser_bind_inline(parser);
+    return 1;
+#else
+    arg_arena_t *arena = &parser->arena;
+    size_t old_n = (size_t)parser->capacity;
+    size_t old_words = ARG_BITSET_WORDS(old_n);
+    size_t words = ARG_BITSET_WORDS(n);
+    /* One chunk for the whole set of arrays when the current one is too small. */
+    size_t total = ARG_ARENA_ROUND(sizeof(arg_t) * n) + ARG_ARENA_ROUND(sizeof(arg_key_t) * n) +
+                   ARG_ARENA_ROUND(sizeof(uint64_t) * words) + ARG_ARENA_ROUND(ARG_RESULT_SIZE(n)) +
+                   ARG_ARENA_ROUND(sizeof(int) * ARG_INDEX_SLOTS(n)) + ARG_ARENA_ROUND(sizeof(int) * n);
+    if (!arg_arena_ensure(arena, total)) {
+        return 0;
+    }
+    arg_t *args = (arg_t *)arg_arena_realloc(arena, (void *)parser->schema.args, sizeof(arg_t) * old_n, sizeof(arg_t) * n);
+    arg_key_t *keys = (arg_key_t *)arg_arena_realloc(arena, parser->schema.keys, sizeof(arg_key_t) * old_n, sizeof(arg_key_t) * n);
+    uint64_t *required = (uint64_t *)arg_arena_realloc(arena, parser->schema.required, sizeof(uint64_t) * old_words, sizeof(uint64_t) * words);
+    /* The result keeps the packed layout of `arg_result_init`, so it can be cleared in bulk. */
+    arg_value_t *typed = (arg_value_t *)arg_arena_alloc(arena, ARG_RESULT_SIZE(n));
+    int *index = (int *)arg_arena_alloc(arena, sizeof(int) * ARG_INDEX_SLOTS(n));
+    int *sorted = (int *)arg_arena_alloc(arena, sizeof(int) * n);
+    if (!args || !keys || !required || !typed || !index || !sorted) {
+        return 0;
+    }
+    uint64_t *set = (uint64_t *)(typed + n);
+    arg_ref_t *values = (arg_ref_t *)(set + words);
+    memset(required + old_words, 0, (words - old_words) * sizeof(uint64_t));
+    memset(set + old_words, 0, (words - old_words) * sizeof(uint64_t));
+    if (old_n) {
+        memcpy(typed, parser->result.typed, sizeof(arg_value_t) * old_n);
+        memcpy(set, parser->result.set, sizeof(uint64_t) * old_words);
+        memcpy(values, parser->result.values, sizeof(arg_ref_t) * old_n);
+    }
+    parser->schema.args = args;
+    parser->schema.keys = keys;
+    parser->schema.required = required;
+    parser->result.typed = typed;
+    parser->result.set = set;
+    parser->result.values = values;
+    parser->schema.sorted = sorted;
+    parser->schema.sorted_for = -1;
+    arg_index_build(&parser->schema, index, (int)ARG_INDEX_SLOTS(n));
+    parser->capacity = n;
+    return 1;
+#endif
+}
+
+arg_id_t arg_parser_add(arg_parser_t *parser, const char *short_name, const char *long_name, arg_type_t type, bool required, const char *description) {
+    if (parser->frozen) {
+        return -1;
+    }
+    if (parser->schema.count == parser->capacity) {
+#ifdef TINYARGS_MAX_ARGS
+        /* The inline storage is bound whole on the first add, whatever its size; after that it is full. */
+        int capacity = parser->capacity + 1;
+#else
+        int capacity = parser->capacity ? parser->capacity * 2 : ARG_MIN_CAPACITY;
+#endif
+        if (!arg_parser_reserve(parser, capacity)) {
+            return -1;
+        }
+    }
+    int i = parser->schema.count;
+    /* Only heap-owned tables reach this point, so writing through `args` is safe. */
+    arg_t *arg = (arg_t *)&parser->schema.args[i];
+    arg->short_name = short_name;
+    arg->long_name = long_name;
+    arg->type = type;
+    arg->required = required;
+    arg->description = description;
+    arg->env = NULL;
+    arg_key_init(&parser->schema.keys[i], arg);
+    if (arg_name_dashless(short_name) || arg_name_dashless(long_name)) {
+        parser->schema.dashless = true;
+    }
+    if (type == ARG_TYPE_LIST) {
+        parser->schema.lists = true;
+    }
+    if (required) {
+        arg_bit_set(parser->schema.required, i);
+    }
+    memset(&parser->result.typed[i], 0, sizeof(arg_value_t));
+    parser->result.values[i].index = -1;
+    parser->schema.count++;
+    arg_index_insert(&parser->schema, i << 1);
+    arg_index_insert(&parser->schema, (i << 1) | 1);
+    return i;
+}
+
+/*
+ * Wide parses (`arg_parser_parse_w`) run through the same loop as narrow ones
+ * and read their tokens through this state; the wide-character code that
+ * fills it follows the fallbacks below.
+ */
+
+struct arg_wide_key {
+    const wchar_t *short_name;
+    const wchar_t *long_name;
+    uint16_t short_len;
+    uint16_t long_len;
+};
+
+struct arg_wide {
+    wchar_t **argv;             /* Vector being parsed, reordered in place */
+    arg_arena_t *arena;         /* Source of the buffers below */
+    struct arg_wide_key *keys;  /* Wide names, parallel to the schema's keys */
+    int count;                  /* Number of arguments the names were encoded for */
+    char *name;                 /* Narrowed token name, for schemas matched by `lookup` */
+    size_t name_cap;            /* UTF-8 bytes of the longest name */
+    char **values;              /* UTF-8 copy of each argument's value, once converted */
+    size_t *value_caps;         /* Bytes each of `values` has room for */
+    uint64_t *converted;        /* Bitset of values converted since the last parse */
+    int capacity;               /* Number of arguments the value arrays have room for */
+    char *scratch;              /* Narrowed typed values, subcommand names and error tokens */
+    size_t scratch_cap;
+};
+
+static unsigned int arg_wide_classify(const wchar_t *token, size_t *len, size_t *eq);
+static int arg_wide_find(const arg_schema_t *schema, struct arg_wide *wide, const wchar_t *name, size_t len ARG_STATS_PARAM);
+static int arg_wide_find_prefix(const arg_schema_t *schema, const struct arg_wide *wide, const wchar_t *name, size_t len ARG_STATS_PARAM);
+static const char* arg_wide_typed_text(struct arg_wide *wide, uint8_t type, const wchar_t *text);
+
+/*
+ * Token classification. Before any lookup, each token is scanned once for its
+ * length and first '=', 16 bytes at a time where SSE2 or NEON is available.
+ * Loads are 16-byte aligned, so they never cross into an unmapped page even
+ * when they read past the terminator.
+ */
+
+#define ARG_TOKEN_DASH 1u   /* Starts with '-' */
+#define ARG_TOKEN_LONG 2u   /* Starts with "--" */
+#define ARG_TOKEN_END  4u   /* Is exactly "--" */
+#define ARG_TOKEN_EQ   8u   /* Contains '=' after the leading "--" */
+
+#if defined(TINYARGS_HAVE_SSE2) || defined(TINYARGS_HAVE_NEON)
+static unsigned int arg_ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctzll(x);
+#else
+    unsigned int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+#if defined(TINYARGS_HAVE_SSE2)
+#define ARG_SCAN_BITS 1     /* Mask bits per byte */
+static void arg_scan_block(const char *block, uint64_t *nul, uint64_t *eq) {
+    __m128i chunk = _mm_load_si128((const __m128i *)(const void *)block);
+    *nul = (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+    *eq = (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('=')));
+}
+#else
+#define ARG_SCAN_BITS 4     /* Mask bits per byte */
+/* Narrows a byte-wise comparison to a nibble per byte. */
+static uint64_t arg_neon_mask(uint8x16_t cmp) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+}
+
+static void arg_scan_block(const char *block, uint64_t *nul, uint64_t *eq) {
+    uint8x16_t chunk = vld1q_u8((const uint8_t *)block);
+    *nul = arg_neon_mask(vceqq_u8(chunk, vdupq_n_u8(0)));
+    *eq = arg_neon_mask(vceqq_u8(chunk, vdupq_n_u8('=')));
+}
+#endif
+
+/* Returns the length of `token` and stores the offset of its first '=' (or the length) in `*eq`. */
+static size_t arg_scan(const char *token, size_t *eq) {
+    size_t misalign = (uintptr_t)token & 15;
+    const char *block = token - misalign;
+    uint64_t nul, eqs;
+    arg_scan_block(block, &nul, &eqs);
+    nul >>= misalign * ARG_SCAN_BITS;
+    eqs >>= misalign * ARG_SCAN_BITS;
+    size_t base = 0;
+    size_t eq_at = (size_t)-1;
+    for (;;) {
+        if (eq_at == (size_t)-1 && eqs) {
+            eq_at = base + arg_ctz64(eqs) / ARG_SCAN_BITS;
+        }
+        if (nul) {
+            size_t len = base + arg_ctz64(nul) / ARG_SCAN_BITS;
+            *eq = eq_at < len ? eq_at : len;
+            return len;
+        }
+        base += 16 - misalign;
+        misalign = 0;
+        block += 16;
+        arg_scan_block(block, &nul, &eqs);
+    }
+}
+#else
+static size_t arg_scan(const char *token, size_t *eq) {
+    size_t len = 0;
+    while (token[len] && token[len] != '=') {
+        len++;
+    }
+    *eq = len;
+    while (token[len]) {
+        len++;
+    }
+    return len;
+}
+#endif
+
+static unsigned int arg_classify(const char *token, size_t *len, size_t *eq) {
+    *len = arg_scan(token, eq);
+    if (token[0] != '-') {
+        return 0;
+    }
+    if (token[1] != '-') {
+        return ARG_TOKEN_DASH;
+    }
+    if (*len == 2) {
+        return ARG_TOKEN_DASH | ARG_TOKEN_LONG | ARG_TOKEN_END;
+    }
+    return ARG_TOKEN_DASH | ARG_TOKEN_LONG | (*eq < *len ? ARG_TOKEN_EQ : 0u);
+}
+
+static const char* arg_key_name(const arg_schema_t *schema, const arg_key_t *key) {
+    return arg_schema_string(schema, key->long_name ? key->long_name : key->short_name);
+}
+
+/*
+ * List values. Each occurrence of a list argument is appended to the shared
+ * `items` log together with its id. When the parse ends, a counting sort makes
+ * each argument's values contiguous; when only one list argument occurred
+ * (the common case) the log is already in that order and nothing moves. The
+ * upper half of `items` is the scratch space for the sort.
+ */
+
+static bool arg_items_grow(arg_result_t *result) {
+    if (!result->arena) {
+        return false;
+    }
+    int capacity = result->item_capacity ? result->item_capacity * 2 : ARG_MIN_CAPACITY;
+    arg_ref_t *items = (arg_ref_t *)arg_arena_alloc(result->arena, (size_t)capacity * (2 * sizeof(arg_ref_t) + sizeof(int)));
+    if (!items) {
+        return false;
+    }
+    int *ids = (int *)(items + 2 * (size_t)capacity);
+    if (result->item_count) {
+        memcpy(items, result->items, sizeof(arg_ref_t) * result->item_count);
+        memcpy(ids, result->item_ids, sizeof(int) * result->item_count);
+    }
+    result->items = items;
+    result->item_ids = ids;
+    result->item_capacity = capacity;
+    return true;
+}
+
+static bool arg_items_push(arg_result_t *result, int j, arg_ref_t ref) {
+    if (result->item_count == result->item_capacity && !arg_items_grow(result)) {
+        return false;
+    }
+    result->items[result->item_count] = ref;
+    result->item_ids[result->item_count] = j;
+    result->item_count++;
+    return true;
+}
+
+/* Forgets the list values of the previous parse, which refer to its `argv`. */
+static void arg_items_begin(const arg_schema_t *schema, arg_result_t *result) {
+    if (schema->lists) {
+        for (int j = 0; j < schema->count; j++) {
+            if (schema->keys[j].type == ARG_TYPE_LIST) {
+                result->typed[j].list.first = 0;
+                result->typed[j].list.count = 0;
+            }
+        }
+    }
+    result->item_count = 0;
+}
+
+/* Groups the logged values by argument, keeping command-line order within each. */
+static void arg_items_group(arg_result_t *result) {
+    int n = result->item_count;
+    const int *ids = result->item_ids;
+    bool grouped = true;
+    for (int k = 0; k < n; k++) {
+        result->typed[ids[k]].list.count++;
+        grouped = grouped && ids[k] == ids[0];
+    }
+    if (grouped) {
+        if (n) {
+            result->typed[ids[0]].list.first = 0;
+        }
+        return;
+    }
+    /* Runs are laid out in order of first occurrence; counts restart as fill cursors. */
+    int next = 0;
+    for (int k = 0; k < n; k++) {
+        arg_value_t *run = &result->typed[ids[k]];
+        if (run->list.count > 0) {
+            run->list.first = next;
+            next += run->list.count;
+            run->list.count = -run->list.count;
+        }
+    }
+    arg_ref_t *scratch = result->items + result->item_capacity;
+    for (int k = 0; k < n; k++) {
+        arg_value_t *run = &result->typed[ids[k]];
+        if (run->list.count < 0) {
+            run->list.count = 0;
+        }
+        scratch[run->list.first + run->list.count++] = result->items[k];
+    }
+    memcpy(result->items, scratch, sizeof(arg_ref_t) * n);
+}
+
+/* Records why parsing failed; returns false so callers can `return arg_fail(...)`. */
+static bool arg_fail(arg_result_t *result, arg_error_code_t code, int index, int offset, int id) {
+    result->error.code = code;
+    result->error.index = index;
+    result->error.offset = offset;
+    result->error.id = id;
+    return false;
+}
+
+/*
+ * Records that argument `j` takes its value from `argv[index] + offset` and
+ * converts it. On the wide path (`wide` set) only typed values are narrowed.
+ */
+static bool arg_store_value(const arg_schema_t *schema, arg_result_t *result, struct arg_wide *wide, int j, int index, int offset) {
+    result->values[j].index = index;
+    result->values[j].offset = offset;
+    if (schema->keys[j].type == ARG_TYPE_LIST && !arg_items_push(result, j, result->values[j])) {
+        return arg_fail(result, ARG_ERROR_NO_MEMORY, index, offset, j);
+    }
+    const char *text = wide ? arg_wide_typed_text(wide, schema->keys[j].type, wide->argv[index] + offset)
+                            : result->argv[index] + offset;
+    if (!text) {
+        return arg_fail(result, ARG_ERROR_NO_MEMORY, index, offset, j);
+    }
+    if (!arg_convert(schema->keys[j].type, text, &result->typed[j])) {
+        return arg_fail(result, ARG_ERROR_INVALID_VALUE, index, offset, j);
+    }
+    return true;
+}
+
+/*
+ * Takes the value of argument `j` from the token after `*i`, if there is one.
+ * When tokens are still arriving (`pending` is set), a missing value is left
+ * for the next token instead.
+ */
+static bool arg_take_next_value(const arg_schema_t *schema, arg_result_t *result, struct arg_wide *wide, int j, int *i, int *pending) {
+    if (*i + 1 < result->argc) {
+        return arg_store_value(schema, result, wide, j, ++*i, 0);
+    }
+    if (pending) {
+        *pending = j;
+        return true;
+    }
+    if (arg_bit_test(schema->required, j)) {
+        return arg_fail(result, ARG_ERROR_MISSING_VALUE, *i, 0, j);
+    }
+    return true;
+}
+
+/*
+ * Handles `-abc` (bundled flags) and `-kVALUE`: each letter is looked up as a
+ * two-character short name, and the first one that takes a value consumes the
+ * rest of the token, or the next token when nothing is left. That letter's id
+ * is stored in `*valued`.
+ */
+static int arg_parse_short_cluster(const arg_schema_t *schema, arg_result_t *result, struct arg_wide *wide, int *i, size_t len, int *valued, int *pending) {
+    for (size_t pos = 1; pos < len; pos++) {
+        int j;
+        if (wide) {
+            wchar_t name[2] = { L'-', wide->argv[*i][pos] };
+            j = arg_wide_find(schema, wide, name, 2 ARG_STATS_PASS(result->stats));
+        } else {
+            char name[2] = { '-', result->argv[*i][pos] };
+            j = arg_index_find_n(schema, name, 2 ARG_STATS_PASS(result->stats));
+        }
+        if (j < 0) {
+            return pos == 1 ? -1 : arg_fail(result, ARG_ERROR_UNRECOGNIZED, *i, 0, -1);
+        }
+        arg_bit_set(result->set, j);
+        ARG_MATCHED(result, j, *i);
+        if (schema->keys[j].type != ARG_TYPE_FLAG) {
+            *valued = j;
+            if (pos + 1 < len) {
+                return arg_store_value(schema, result, wide, j, *i, (int)pos + 1);
+            }
+            return arg_take_next_value(schema, result, wide, j, i, pending);
+        }
+    }
+    return 1;
+}
+
+/* Looks up the first `len` units of token `i`, from the wide vector when `wide` is set. */
+static int arg_token_find(const arg_schema_t *schema, arg_result_t *result, struct arg_wide *wide, int i, size_t len) {
+    if (wide) {
+        return arg_wide_find(schema, wide, wide->argv[i], len ARG_STATS_PASS(result->stats));
+    }
+    return arg_index_find_n(schema, result->argv[i], len ARG_STATS_PASS(result->stats));
+}
+
+/*
+ * Parses the option in `argv[*i]`, leaving `*i` on the last token it consumed
+ * and the id of the argument that took a value in `*valued`; with `pending`,
+ * an argument whose value is the next token to arrive goes in `*pending`.
+ * Returns 1 on success, 0 after recording an error, and -1 if the token is not
+ * an option. Lengths and offsets count units of the token, bytes or `wchar_t`.
+ */
+static int arg_parse_option(const arg_schema_t *schema, arg_result_t *result, struct arg_wide *wide, int *i, size_t len, size_t eq, unsigned int cls, int *valued, int *pending) {
+    int j = arg_token_find(schema, result, wide, *i, len);
+    if (j >= 0) {
+        arg_bit_set(result->set, j);
+        ARG_MATCHED(result, j, *i);
+        *valued = j;
+        return schema->keys[j].type == ARG_TYPE_FLAG || arg_take_next_value(schema, result, wide, j, i, pending);
+    }
+
+    if (cls & ARG_TOKEN_LONG) {
+        size_t name_len = eq;
+        j = (cls & ARG_TOKEN_EQ) ? arg_token_find(schema, result, wide, *i, name_len) : -1;
+        if (j < 0) {
+            int first = 0;
+            j = wide ? arg_wide_find_prefix(schema, wide, wide->argv[*i], name_len ARG_STATS_PASS(result->stats))
+                     : arg_sorted_find_prefix(schema, result->argv[*i], name_len, &first ARG_STATS_PASS(result->stats));
+            if (j == ARG_PREFIX_AMBIGUOUS) {
+                return arg_fail(result, ARG_ERROR_AMBIGUOUS, *i, 0, -1);
+            }
+        }
+        if (j >= 0) {
+            arg_bit_set(result->set, j);
+            ARG_MATCHED(result, j, *i);
+            *valued = j;
+            if (!(cls & ARG_TOKEN_EQ)) {
+                return schema->keys[j].type == ARG_TYPE_FLAG || arg_take_next_value(schema, result, wide, j, i, pending);
+            }
+            if (schema->keys[j].type == ARG_TYPE_FLAG) {
+                return arg_fail(result, ARG_ERROR_UNEXPECTED_VALUE, *i, (int)eq + 1, j);
+            }
+            return arg_store_value(schema, result, wide, j, *i, (int)eq + 1);
+        }
+    } else if ((cls & ARG_TOKEN_DASH) && len > 2) {
+        return arg_parse_short_cluster(schema, result, wide, i, len, valued, pending);
+    }
+    return -1;
+}
+
+/*
+ * Moves the tokens `argv[start..end)` of an option in front of the `count`
+ * positionals starting at `*first`, which end at `start`, and follows the value
+ * of argument `valued` if it was among them. At most two tokens are moved, in
+ * the wide vector instead when `wide` is set.
+ */
+static void arg_hoist_option(arg_result_t *result, wchar_t **wide, int *first, int count, int start, int end, int valued) {
+    int n = end - start;
+    if (!wide) {
+        char *moved[2];
+        memcpy(moved, &result->argv[start], sizeof(char *) * n);
+        memmove(&result->argv[*first + n], &result->argv[*first], sizeof(char *) * count);
+        memcpy(&result->argv[*first], moved, sizeof(char *) * n);
+    } else {
+        wchar_t *wmoved[2];
+        memcpy(wmoved, &wide[start], sizeof(wchar_t *) * n);
+        memmove(&wide[*first + n], &wide[*first], sizeof(wchar_t *) * count);
+        memcpy(&wide[*first], wmoved, sizeof(wchar_t *) * n);
+    }
+    if (valued >= 0 && result->values[valued].index >= start && result->values[valued].index < end) {
+        result->values[valued].index -= start - *first;
+        /* A list value stored for this token is the last one logged. */
+        if (result->item_count && result->item_ids[result->item_count - 1] == valued &&
+            result->items[result->item_count - 1].index >= start) {
+            result->items[result->item_count - 1].index -= start - *first;
+        }
+    }
+    *first += n;
+}
+
+/* Parses `argv`, or the wide vector of `wide` when it is set and `argv` is NULL; see `arg_schema_parse`. */
+static int arg_scan_vector(const arg_schema_t *schema, arg_result_t *result, int argc, char *argv[], struct arg_wide *wide) {
+    wchar_t **wargv = wide ? wide->argv : NULL;
+    arg_result_forget(schema, result);
+    result->argv = argv;
+    result->argc = argc;
+    arg_error_clear(&result->error);
+    arg_items_begin(schema, result);
+    /* Positionals seen so far occupy argv[first..first + count), which always ends at `i`. */
+    int first = argc;
+    int count = 0;
+    for (int i = 1; i < argc; i++) {
+        size_t len;
+        size_t eq;
+        unsigned int cls = wargv ? arg_wide_classify(wargv[i], &len, &eq) : arg_classify(argv[i], &len, &eq);
+        ARG_STAT(result->stats, tokens, 1);
+        if (cls & ARG_TOKEN_END) {
+            if (count) {
+                arg_hoist_option(result, wargv, &first, count, i, i + 1, -1);
+            } else {
+                first = i + 1;
+            }
+            count += argc - i - 1;
+            break;
+        }
+        int start = i;
+        int valued = -1;
+        /* Without dashless names, a token not starting with '-' cannot be an option. */
+        int status = (cls & ARG_TOKEN_DASH) || schema->dashless ? arg_parse_option(schema, result, wide, &i, len, eq, cls, &valued, NULL) : -1;
+        if (status == 0) {
+            return 0;
+        }
+        if (status > 0) {
+            if (count) {
+                arg_hoist_option(result, wargv, &first, count, start, i + 1, valued);
+            }
+            continue;
+        }
+        if ((cls & ARG_TOKEN_DASH) && len > 1) {
+            return arg_fail(result, ARG_ERROR_UNRECOGNIZED, i, 0, -1);
+        }
+        /* A subcommand name ends option parsing; it and what follows belong to the subcommand. */
+        if (schema->commands) {
+            first = i;
+            count = argc - i;
+            break;
+        }
+        if (!count) {
+            first = i;
+        }
+        count++;
+    }
+    result->positional_first = first;
+    result->positional_count = count;
+    arg_items_group(result);
+
+    int missing = arg_next_missing(schema, result, 0);
+    if (missing >= 0) {
+        return arg_fail(result, ARG_ERROR_MISSING_REQUIRED, -1, 0, missing);
+    }
+
+    return 1;
+}
+
+int arg_schema_parse(const arg_schema_t *schema, arg_result_t *result, int argc, char *argv[]) {
+    return arg_scan_vector(schema, result, argc, argv, NULL);
+}
+
+/*
+ * Batches. Every vector is parsed into its own result against the shared,
+ * read-only schema, so shards of a batch can run on separate threads without
+ * any synchronization and still produce exactly the serial results.
+ */
+
+#define ARG_BATCH_MAX_THREADS 64
+
+struct arg_batch {
+    const arg_schema_t *schema;
+    const int *argcs;
+    char ***argvs;
+    arg_result_t *results;
+    int first;                  /* First vector of the shard */
+    int count;                  /* Number of vectors in the shard */
+    int parsed;                 /* Vectors of the shard that parsed successfully */
+};
+
+static void* arg_batch_run(void *arg) {
+    struct arg_batch *batch = (struct arg_batch *)arg;
+    batch->parsed = 0;
+    for (int k = batch->first; k < batch->first + batch->count; k++) {
+        arg_result_reset(batch->schema, &batch->results[k]);
+        batch->parsed += arg_schema_parse(batch->schema, &batch->results[k], batch->argcs[k], batch->argvs[k]);
+    }
+    return NULL;
+}
+
+int arg_parser_parse_batch(const arg_schema_t *schema, int n, const int argcs[], char **argvs[], arg_result_t results[]) {
+    return arg_parser_parse_batch_threads(schema, n, argcs, argvs, results, 1);
+}
+
+int arg_parser_parse_batch_threads(const arg_schema_t *schema, int n, const int argcs[], char **argvs[], arg_result_t results[], int threads) {
+    if (n <= 0) {
+        return 0;
+    }
+    if (threads > ARG_BATCH_MAX_THREADS) {
+        threads = ARG_BATCH_MAX_THREADS;
+    }
+    if (threads > n) {
+        threads = n;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    struct arg_batch shards[ARG_BATCH_MAX_THREADS];
+    int first = 0;
+    for (int t = 0; t < threads; t++) {
+        int count = n / threads + (t < n % threads);
+        struct arg_batch shard = { schema, argcs, argvs, results, first, count, 0 };
+        shards[t] = shard;
+        first += count;
+    }
+#ifdef TINYARGS_THREADS
+    pthread_t workers[ARG_BATCH_MAX_THREADS];
+    bool started[ARG_BATCH_MAX_THREADS];
+    for (int t = 1; t < threads; t++) {
+        started[t] = pthread_create(&workers[t], NULL, arg_batch_run, &shards[t]) == 0;
+    }
+    arg_batch_run(&shards[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(workers[t], NULL);
+        } else {
+            arg_batch_run(&shards[t]);
+        }
+    }
+#else
+    for (int t = 0; t < threads; t++) {
+        arg_batch_run(&shards[t]);
+    }
+#endif
+    int parsed = 0;
+    for (int t = 0; t < threads; t++) {
+        parsed += shards[t].parsed;
+    }
+    return parsed;
+}
+
+/*
+ * Error messages. Parsing only records an `arg_error_t`; the message, with any
+ * abbreviation candidates or "did you mean" suggestion, is rebuilt from it and
+ * the result's `argv` when someone asks for it.
+ */
+
+static void arg_error_render(const arg_schema_t *schema, const arg_result_t *result, arg_text_t *text) {
+    const arg_error_t *error = &result->error;
+    const char *token = error->index >= 0 && error->index < result->argc ? result->argv[error->index] : "";
+    const char *name = error->id >= 0 && error->id < schema->count ? arg_key_name(schema, &schema->keys[error->id]) : "";
+    bool is_long = token[0] == '-' && token[1] == '-';
+    size_t name_len = strcspn(token, "=");
+    switch (error->code) {
+        case ARG_ERROR_NONE:
+            break;
+        case ARG_ERROR_UNRECOGNIZED: {
+            int suggestion = is_long ? arg_sorted_suggest(schema, token, name_len) : -1;
+            if (suggestion >= 0) {
+                arg_text_printf(text, "Error: Unrecognized argument %s (did you mean %s?)\n", token,
+                                arg_schema_string(schema, schema->keys[suggestion].long_name));
+            } else {
+                arg_text_printf(text, "Error: Unrecognized argument %s\n", token);
+            }
+            break;
+        }
+        case ARG_ERROR_AMBIGUOUS: {
+            int first = 0;
+            arg_sorted_find_prefix(schema, token, name_len, &first ARG_STATS_PASS(NULL));
+            arg_text_printf(text, "Error: Ambiguous argument %.*s (could be", (int)name_len, token);
+            for (int i = first; i < schema->sorted_count && arg_has_prefix(schema, schema->sorted[i], token, name_len); i++) {
+                arg_text_printf(text, "%s %s", i == first ? "" : ",", arg_schema_string(schema, schema->keys[schema->sorted[i]].long_name));
+            }
+            arg_text_append(text, ")\n", 2);
+            break;
+        }
+        case ARG_ERROR_UNEXPECTED_VALUE:
+            arg_text_printf(text, "Error: Argument %s does not take a value\n", name);
+            break;
+        case ARG_ERROR_MISSING_VALUE:
+            arg_text_printf(text, "Error: Missing value for argument %s\n", token);
+            break;
+        case ARG_ERROR_INVALID_VALUE:
+            arg_text_printf(text, "Error: Invalid value for argument %s: %s\n", name, token + error->offset);
+            break;
+        case ARG_ERROR_MISSING_REQUIRED:
+            arg_text_printf(text, "Error: Missing required argument %s\n", name);
+            break;
+        case ARG_ERROR_NO_MEMORY:
+            if (error->id >= 0) {
+                arg_text_printf(text, "Error: Out of memory while storing a value for argument %s\n", name);
+            } else {
+                arg_text_printf(text, "Error: Out of memory while expanding %s\n", token);
+            }
+            break;
+        case ARG_ERROR_UNKNOWN_COMMAND:
+            arg_text_printf(text, "Error: Unknown command %s\n", token);
+            break;
+        case ARG_ERROR_COMMAND_FAILED:
+            arg_text_printf(text, "Error: Could not set up command %s\n", token);
+            break;
+    }
+}
+
+/* Formats the error recorded in `result` and sends it to the schema's sink. */
+static void arg_report(const arg_schema_t *schema, const arg_result_t *result) {
+    char storage[256];
+    arg_text_t text;
+    arg_text_init(&text, storage, sizeof(storage), false);
+    arg_error_render(schema, result, &text);
+    arg_output(schema, ARG_OUTPUT_ERROR, &text);
+    arg_text_free(&text);
+}
+
+/*
+ * Response files. A `@path` token is replaced by the tokens in `path`, split on
+ * whitespace with shell-like quoting. The file is mapped copy-on-write where
+ * possible and tokenized in place, so tokens point straight into the mapping.
+ * A token naming a file that cannot be read is kept as is.
+ */
+
+static bool arg_push_token(arg_parser_t *parser, int *count, char *token) {
+    if (*count == parser->token_capacity) {
+        int capacity = parser->token_capacity ? parser->token_capacity * 2 : ARG_MIN_CAPACITY;
+        char **tokens = (char **)arg_arena_realloc(&parser->arena, parser->tokens,
+                                                   sizeof(char *) * parser->token_capacity, sizeof(char *) * capacity);
+        if (!tokens) {
+            return false;
+        }
+        parser->tokens = tokens;
+        parser->token_capacity = capacity;
+    }
+    parser->tokens[(*count)++] = token;
+    return true;
+}
+
+/*
+ * Reads the whole stream into `response->buffer`, with one spare byte for a
+ * terminator. The buffer is allocated from the arena on first use and only
+ * ever grows, so a reused response reads into the room it already has.
+ */
+static char* arg_response_read(arg_arena_t *arena, struct arg_response *response, FILE *file, size_t *len) {
+    size_t size = 0;
+    if (!response->buffer) {
+        response->buffer = (char *)arg_arena_alloc(arena, 4096);
+        response->buffer_cap = response->buffer ? 4096 : 0;
+    }
+    char *data = response->buffer;
+    while (data) {
+        size_t capacity = response->buffer_cap;
+        size += fread(data + size, 1, capacity - size - 1, file);
+        if (size < capacity - 1) {
+            break;
+        }
+        data = (char *)arg_arena_realloc(arena, data, capacity, capacity * 2);
+        if (data) {
+            response->buffer = data;
+            response->buffer_cap = capacity * 2;
+        }
+    }
+    if (ferror(file)) {
+        data = NULL;
+    }
+    *len = size;
+    return data;
+}
+
+/* Opens `path` into `spare` when given one to reuse, and into a new response otherwise. */
+static struct arg_response* arg_response_load(arg_arena_t *arena, const char *path, size_t *len, struct arg_response *spare) {
+    struct arg_response *response = spare;
+    if (!response) {
+        response = (struct arg_response *)arg_arena_alloc(arena, sizeof(struct arg_response));
+        if (!response) {
+            return NULL;
+        }
+        response->buffer = NULL;
+        response->buffer_cap = 0;
+    }
+    response->data = NULL;
+    response->mapped = 0;
+#ifdef TINYARGS_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    long page = sysconf(_SC_PAGESIZE);
+    /* The terminator of the last token goes in the zero-filled tail of the last page. */
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && page > 0 && st.st_size % page != 0) {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            response->data = (char *)data;
+            response->mapped = (size_t)st.st_size;
+            *len = (size_t)st.st_size;
+        }
+    }
+    if (!response->data) {
+        FILE *file = fdopen(fd, "rb");
+        if (file) {
+            response->data = arg_response_read(arena, response, file, len);
+            fclose(file);
+            fd = -1;
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+#else
+    FILE *file = fopen(path, "rb");
+    if (file) {
+        response->data = arg_response_read(arena, response, file, len);
+        fclose(file);
+    }
+#endif
+    return response->data ? response : NULL;
+}
+
+/* Only mappings need undoing; everything else is reclaimed with the arena. */
+static void arg_response_unmap(struct arg_response *response) {
+#ifdef TINYARGS_HAVE_MMAP
+    for (; response; response = response->next) {
+        if (response->mapped) {
+            munmap(response->data, response->mapped);
+            response->mapped = 0;
+        }
+    }
+#else
+    (void)response;
+#endif
+}
+
+/*
+ * Releases the response files of the previous parse, which nothing refers to
+ * once a new argument vector is parsed, and keeps their records and read
+ * buffers for the next ones, so repeated parses hold a bounded set of mappings
+ * and stop drawing on the arena.
+ */
+static void arg_parser_drop_responses(arg_parser_t *parser) {
+    struct arg_response *response = parser->responses;
+    arg_response_unmap(response);
+    while (response) {
+        struct arg_response *next = response->next;
+        response->data = NULL;
+        response->next = parser->spare_responses;
+        parser->spare_responses = response;
+        response = next;
+    }
+    parser->responses = NULL;
+}
+
+static bool arg_expand_token(arg_parser_t *parser, int *count, char *token, int depth);
+
+static bool arg_is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/* Splits `data[0..len)` into tokens in place; `data[len]` must be writable. */
+static bool arg_response_tokenize(arg_parser_t *parser, int *count, char *data, size_t len, int depth) {
+    char *src = data;
+    char *end = data + len;
+    while (src < end) {
+        while (src < end && arg_is_space(*src)) {
+            src++;
+        }
+        if (src == end) {
+            break;
+        }
+        char *token = src;
+        char *dst = src;
+        char quote = 0;
+        while (src < end && (quote || !arg_is_space(*src))) {
+            char c = *src++;
+            if (quote && c == quote) {
+                quote = 0;
+            } else if (!quote && (c == '"' || c == '\'')) {
+                quote = c;
+            } else if (c == '\\' && quote != '\'' && src < end) {
+                *dst++ = *src++;
+            } else {
+                *dst++ = c;
+            }
+        }
+        /* The separator (or the spare byte past the end) is free to hold the terminator. */
+        if (src < end) {
+            src++;
+        }
+        *dst = '\0';
+        if (!arg_expand_token(parser, count, token, depth)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool arg_expand_token(arg_parser_t *parser, int *count, char *token, int depth) {
+    if (token[0] != '@' || depth >= ARG_RESPONSE_MAX_DEPTH) {
+        return arg_push_token(parser, count, token);
+    }
+    size_t len = 0;
+    struct arg_response *spare = parser->spare_responses;
+    struct arg_response *response = arg_response_load(&parser->arena, token + 1, &len, spare);
+    if (!response) {
+        return arg_push_token(parser, count, token);
+    }
+    if (response == spare) {
+        parser->spare_responses = spare->next;
+    }
+    response->next = parser->responses;
+    parser->responses = response;
+    return arg_response_tokenize(parser, count, response->data, len, depth + 1);
+}
+
+/*
+ * Fallback values. Arguments missing from argv may take a value from their
+ * environment variable or from the config file. Nothing is looked up until an
+ * accessor asks for such an argument; the outcome, found or not, is then
+ * cached per argument, so each variable is read and each key searched for at
+ * most once.
+ */
+
+struct arg_fallback {
+    struct arg_response *config;    /* Config file, or NULL */
+    size_t config_len;              /* Length of the config text */
+    const char **values;            /* Fallback text of each argument, or NULL */
+    arg_value_t *typed;             /* Converted fallback of each typed argument */
+    uint64_t *resolved;             /* Bitset of arguments already looked up */
+    int capacity;                   /* Number of arguments the arrays have room for */
+};
+
+/* Returns the fallback state with room for every registered argument, or NULL. */
+static struct arg_fallback* arg_fallback_fit(arg_parser_t *parser) {
+    struct arg_fallback *fb = parser->fallback;
+    if (!fb) {
+        fb = (struct arg_fallback *)arg_arena_alloc(&parser->arena, sizeof(struct arg_fallback));
+        if (!fb) {
+            return NULL;
+        }
+        memset(fb, 0, sizeof(struct arg_fallback));
+        parser->fallback = fb;
+    }
+    int n = parser->schema.count;
+    if (n > fb->capacity) {
+        int capacity = n > 2 * fb->capacity ? n : 2 * fb->capacity;
+        size_t words = ARG_BITSET_WORDS(capacity);
+        const char **values = (const char **)arg_arena_alloc(&parser->arena, sizeof(char *) * capacity);
+        arg_value_t *typed = (arg_value_t *)arg_arena_alloc(&parser->arena, sizeof(arg_value_t) * capacity);
+        uint64_t *resolved = (uint64_t *)arg_arena_alloc(&parser->arena, sizeof(uint64_t) * words);
+        if (!values || !typed || !resolved) {
+            return NULL;
+        }
+        memset(resolved, 0, sizeof(uint64_t) * words);
+        if (fb->capacity) {
+            memcpy(values, fb->values, sizeof(char *) * fb->capacity);
+            memcpy(typed, fb->typed, sizeof(arg_value_t) * fb->capacity);
+            memcpy(resolved, fb->resolved, sizeof(uint64_t) * ARG_BITSET_WORDS(fb->capacity));
+        }
+        fb->values = values;
+        fb->typed = typed;
+        fb->resolved = resolved;
+        fb->capacity = capacity;
+    }
+    return fb;
+}
+
+/* Whether `key` under `section` spells `name`, as `section.key` or a bare `key`. */
+static bool arg_config_key_is(const char *section, size_t section_len, const char *key, size_t key_len,
+                              const char *name, size_t name_len) {
+    if (!section_len) {
+        return key_len == name_len && memcmp(key, name, name_len) == 0;
+    }
+    return section_len + 1 + key_len == name_len && memcmp(name, section, section_len) == 0 &&
+           name[section_len] == '.' && memcmp(name + section_len + 1, key, key_len) == 0;
+}
+
+/* Finds the last line setting `name` and NUL-terminates its value in place; `data[len]` must be writable. */
+static const char* arg_config_find(char *data, size_t len, const char *name, size_t name_len) {
+    char *p = data;
+    char *end = data + len;
+    const char *section = NULL;
+    size_t section_len = 0;
+    char *found = NULL;
+    char *found_end = NULL;
+    while (p < end) {
+        char *line = p;
+        /* Values found earlier are terminated in place, so a NUL also ends a line. */
+        while (p < end && *p != '\n' && *p != '\0') {
+            p++;
+        }
+        char *eol = p;
+        if (p < end) {
+            p++;
+        }
+        while (line < eol && arg_is_space(*line)) {
+            line++;
+        }
+        if (line == eol || *line == '#' || *line == ';') {
+            continue;
+        }
+        if (*line == '[') {
+            char *close = (char *)memchr(line, ']', (size_t)(eol - line));
+            if (close) {
+                section = line + 1;
+                section_len = (size_t)(close - section);
+            }
+            continue;
+        }
+        char *eq = (char *)memchr(line, '=', (size_t)(eol - line));
+        if (!eq) {
+            continue;
+        }
+        char *key_end = eq;
+        while (key_end > line && arg_is_space(key_end[-1])) {
+            key_end--;
+        }
+        if (!arg_config_key_is(section, section_len, line, (size_t)(key_end - line), name, name_len)) {
+            continue;
+        }
+        char *value = eq + 1;
+        char *value_end = eol;
+        while (value < value_end && arg_is_space(*value)) {
+            value++;
+        }
+        while (value_end > value && arg_is_space(value_end[-1])) {
+            value_end--;
+        }
+        if (value_end - value >= 2 && (*value == '"' || *value == '\'') && value_end[-1] == *value) {
+            value++;
+            value_end--;
+        }
+        found = value;
+        found_end = value_end;
+    }
+    if (found) {
+        *found_end = '\0';
+    }
+    return found;
+}
+
+static const char* arg_config_lookup(const arg_schema_t *schema, struct arg_fallback *fb, const arg_key_t *key) {
+    const char *name = arg_key_name(schema, key);
+    size_t len = key->long_name ? key->long_len : key->short_len;
+    while (len && *name == '-') {
+        name++;
+        len--;
+    }
+    return len ? arg_config_find(fb->config->data, fb->config_len, name, len) : NULL;
+}
+
+/* Fallback text of argument `i`, converted into `fb->typed` for typed arguments, or NULL. */
+static const char* arg_fallback_value(arg_parser_t *parser, int i) {
+    struct arg_fallback *fb = arg_fallback_fit(parser);
+    if (!fb) {
+        return NULL;
+    }
+    if (!arg_bit_test(fb->resolved, i)) {
+        arg_bit_set(fb->resolved, i);
+        const arg_key_t *key = &parser->schema.keys[i];
+        const char *env = arg_schema_string(&parser->schema, parser->schema.args[i].env);
+        const char *text = env ? getenv(env) : NULL;
+        /* A value that does not convert is ignored, leaving the next source. */
+        if (text && !arg_convert(key->type, text, &fb->typed[i])) {
+            text = NULL;
+        }
+        if (!text && fb->config) {
+            text = arg_config_lookup(&parser->schema, fb, key);
+            if (text && !arg_convert(key->type, text, &fb->typed[i])) {
+                text = NULL;
+            }
+        }
+        fb->values[i] = key->type == ARG_TYPE_LIST ? NULL : text;
+    }
+    return fb->values[i];
+}
+
+static bool arg_fallback_truthy(const char *text) {
+    static const char *const off[] = { "", "0", "false", "no", "off", "FALSE", "NO", "OFF", "False", "No", "Off" };
+    for (size_t k = 0; k < sizeof(off) / sizeof(off[0]); k++) {
+        if (strcmp(text, off[k]) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Whether the fallbacks provide argument `i`: with a truthy value for a flag, with any value otherwise. */
+static bool arg_fallback_sets(arg_parser_t *parser, int i) {
+    const char *text = arg_fallback_value(parser, i);
+    return text && (parser->schema.keys[i].type != ARG_TYPE_FLAG || arg_fallback_truthy(text));
+}
+
+int arg_parser_bind_env(arg_parser_t *parser, arg_id_t id, const char *name) {
+    if (parser->is_static || parser->image || id < 0 || id >= parser->schema.count) {
+        return 0;
+    }
+    /* Only heap-owned tables reach this point, so writing through `args` is safe. */
+    ((arg_t *)parser->schema.args)[id].env = name;
+    parser->fallbacks = true;
+    if (parser->fallback && id < parser->fallback->capacity) {
+        parser->fallback->resolved[id >> 6] &= ~((uint64_t)1 << (id & 63));
+    }
+    return 1;
+}
+
+int arg_parser_load_config(arg_parser_t *parser, const char *path) {
+    struct arg_fallback *fb = arg_fallback_fit(parser);
+    if (!fb) {
+        return 0;
+    }
+    size_t len = 0;
+    struct arg_response *config = arg_response_load(&parser->arena, path, &len, NULL);
+    if (!config) {
+        return 0;
+    }
+    config->next = NULL;
+    arg_response_unmap(fb->config);
+    fb->config = config;
+    fb->config_len = len;
+    /* Anything looked up so far may now resolve differently. */
+    memset(fb->resolved, 0, sizeof(uint64_t) * ARG_BITSET_WORDS(fb->capacity));
+    parser->fallbacks = true;
+    return 1;
+}
+
+/*
+ * Wide characters. `wchar_t` holds UTF-16 where it is 16 bits wide (Windows)
+ * and UTF-32 elsewhere; narrow text is UTF-8. Malformed input becomes U+FFFD.
+ */
+
+#if WCHAR_MAX <= 0xffff
+#define ARG_WIDE_UTF16 1
+#endif
+
+/* Next code point of `src[*pos..len)`, advancing `*pos`. */
+static uint32_t arg_wide_decode(const wchar_t *src, size_t len, size_t *pos) {
+    uint32_t c = (uint32_t)src[(*pos)++];
+#ifdef ARG_WIDE_UTF16
+    c &= 0xffff;
+    if (c >= 0xd800 && c < 0xdc00 && *pos < len) {
+        uint32_t low = (uint32_t)src[*pos] & 0xffff;
+        if (low >= 0xdc00 && low < 0xe000) {
+            (*pos)++;
+            return 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+        }
+    }
+    return c >= 0xd800 && c < 0xe000 ? 0xfffd : c;
+#else
+    (void)len;
+    return c > 0x10ffff || (c >= 0xd800 && c < 0xe000) ? 0xfffd : c;
+#endif
+}
+
+/* Next code point of the UTF-8 text `src[*pos..len)`, advancing `*pos`. */
+static uint32_t arg_utf8_decode(const char *src, size_t len, size_t *pos) {
+    const unsigned char *s = (const unsigned char *)src;
+    uint32_t c = s[(*pos)++];
+    if (c < 0x80) {
+        return c;
+    }
+    int extra = c >= 0xf0 && c < 0xf5 ? 3 : c >= 0xe0 ? (c < 0xf0 ? 2 : -1) : c >= 0xc2 ? 1 : -1;
+    if (extra < 0) {
+        return 0xfffd;
+    }
+    c &= 0x3f >> extra;
+    for (int k = 0; k < extra; k++) {
+        if (*pos >= len || (s[*pos] & 0xc0) != 0x80) {
+            return 0xfffd;
+        }
+        c = c << 6 | (s[(*pos)++] & 0x3f);
+    }
+    static const uint32_t least[] = { 0, 0x80, 0x800, 0x10000 };
+    return c < least[extra] || c > 0x10ffff || (c >= 0xd800 && c < 0xe000) ? 0xfffd : c;
+}
+
+/* Encodes `c` into `out`, which has room for 4 bytes; returns the byte count. */
+static size_t arg_utf8_encode(uint32_t c, char *out) {
+    if (c < 0x80) {
+        out[0] = (char)c;
+        return 1;
+    }
+    if (c < 0x800) {
+        out[0] = (char)(0xc0 | c >> 6);
+        out[1] = (char)(0x80 | (c & 0x3f));
+        return 2;
+    }
+    if (c < 0x10000) {
+        out[0] = (char)(0xe0 | c >> 12);
+        out[1] = (char)(0x80 | (c >> 6 & 0x3f));
+        out[2] = (char)(0x80 | (c & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | c >> 18);
+    out[1] = (char)(0x80 | (c >> 12 & 0x3f));
+    out[2] = (char)(0x80 | (c >> 6 & 0x3f));
+    out[3] = (char)(0x80 | (c & 0x3f));
+    return 4;
+}
+
+/* Length in UTF-8 of `src[0..len)`; unless `dst` is NULL, also writes it there, terminated. */
+static size_t arg_wide_narrow_into(const wchar_t *src, size_t len, char *dst) {
+    size_t n = 0;
+    char buf[4];
+    for (size_t pos = 0; pos < len;) {
+        size_t bytes = arg_utf8_encode(arg_wide_decode(src, len, &pos), dst ? dst + n : buf);
+        n += bytes;
+    }
+    if (dst) {
+        dst[n] = '\0';
+    }
+    return n;
+}
+
+/* Narrows `src[0..len)` into `*buf`, growing it from the arena when it is too small. */
+static char* arg_wide_narrow(arg_arena_t *arena, const wchar_t *src, size_t len, char **buf, size_t *cap) {
+    size_t need = arg_wide_narrow_into(src, len, NULL) + 1;
+    if (need > *cap) {
+        char *grown = (char *)arg_arena_alloc(arena, need);
+        if (!grown) {
+            return NULL;
+        }
+        *buf = grown;
+        *cap = need;
+    }
+    arg_wide_narrow_into(src, len, *buf);
+    return *buf;
+}
+
+/*
+ * Subcommands. Only a name, a constructor and a description are kept per
+ * subcommand, in an open-addressing table keyed by name; a subcommand's parser
+ * is built the first time a command line selects it.
+ */
+
+struct arg_command {
+    const char *name;
+    size_t name_len;
+    arg_command_fn build;
+    void *ctx;
+    const char *description;
+    arg_parser_t *child;        /* Parser built for the subcommand, or NULL */
+};
+
+struct arg_commands {
+    struct arg_command *list;   /* Subcommands in registration order */
+    int count;                  /* Number of subcommands */
+    int capacity;               /* Number of subcommands `list` has room for */
+    int *index;                 /* Positions in `list`, or ARG_INDEX_EMPTY */
+    int index_size;             /* Number of slots in `index`, a power of two */
+    int active;                 /* Subcommand selected by the last parse, or -1 */
+};
+
+/* Slot holding the subcommand called `name`, or the empty slot where it would go. */
+static int arg_command_slot(const struct arg_commands *commands, const char *name, size_t len) {
+    unsigned int mask = (unsigned int)commands->index_size - 1;
+    for (unsigned int pos = arg_name_hash(name, len) & mask;; pos = (pos + 1) & mask) {
+        int k = commands->index[pos];
+        if (k == ARG_INDEX_EMPTY ||
+            (commands->list[k].name_len == len && memcmp(commands->list[k].name, name, len) == 0)) {
+            return (int)pos;
+        }
+    }
+}
+
+/* Makes room for one more subcommand, keeping the table at most half full. */
+static bool arg_commands_grow(arg_parser_t *parser) {
+    struct arg_commands *commands = parser->commands;
+    if (!commands) {
+        commands = (struct arg_commands *)arg_arena_alloc(&parser->arena, sizeof(struct arg_commands));
+        if (!commands) {
+            return false;
+        }
+        memset(commands, 0, sizeof(struct arg_commands));
+        commands->active = -1;
+        parser->commands = commands;
+    }
+    if (commands->count == commands->capacity) {
+        int capacity = commands->capacity ? commands->capacity * 2 : ARG_MIN_CAPACITY;
+        struct arg_command *list = (struct arg_command *)arg_arena_realloc(&parser->arena, commands->list,
+            sizeof(struct arg_command) * commands->capacity, sizeof(struct arg_command) * capacity);
+        int *index = (int *)arg_arena_alloc(&parser->arena, sizeof(int) * capacity * 2);
+        if (!list || !index) {
+            return false;
+        }
+        commands->list = list;
+        commands->capacity = capacity;
+        commands->index = index;
+        commands->index_size = capacity * 2;
+        for (int pos = 0; pos < commands->index_size; pos++) {
+            index[pos] = ARG_INDEX_EMPTY;
+        }
+        for (int k = 0; k < commands->count; k++) {
+            index[arg_command_slot(commands, list[k].name, list[k].name_len)] = k;
+        }
+    }
+    return true;
+}
+
+int arg_parser_add_command(arg_parser_t *parser, const char *name, arg_command_fn build, void *ctx, const char *description) {
+    if (parser->frozen || !name || !build || !arg_commands_grow(parser)) {
+        return 0;
+    }
+    struct arg_commands *commands = parser->commands;
+    size_t len = strlen(name);
+    int pos = arg_command_slot(commands, name, len);
+    if (commands->index[pos] != ARG_INDEX_EMPTY) {
+        return 0;
+    }
+    struct arg_command *command = &commands->list[commands->count];
+    command->name = name;
+    command->name_len = len;
+    command->build = build;
+    command->ctx = ctx;
+    command->description = description;
+    command->child = NULL;
+    commands->index[pos] = commands->count++;
+    parser->schema.commands = true;
+    return 1;
+}
+
+/* The parser of subcommand `k`, built on first use. */
+static arg_parser_t* arg_command_child(arg_parser_t *parser, int k) {
+    struct arg_command *command = &parser->commands->list[k];
+    if (!command->child) {
+        arg_arena_t *arena = &parser->arena;
+        arg_parser_t *child = arg_parser_create_with_allocator(arena->alloc, arena->free, arena->ctx);
+        if (!child) {
+            return NULL;
+        }
+        arg_parser_set_output(child, parser->schema.output, parser->schema.output_ctx);
+        if (!command->build(child, command->ctx)) {
+            arg_parser_free(child);
+            return NULL;
+        }
+        arg_parser_freeze(child);
+        command->child = child;
+    }
+    return command->child;
+}
+
+/* Hands the positionals of the parent's last parse, led by the subcommand name, to that subcommand. */
+static int arg_command_dispatch(arg_parser_t *parser) {
+    struct arg_commands *commands = parser->commands;
+    arg_result_t *result = &parser->result;
+    commands->active = -1;
+    if (!result->positional_count) {
+        return 1;
+    }
+    const char *name;
+    if (parser->wargv) {
+        const wchar_t *wname = parser->wargv[result->positional_first];
+        name = arg_wide_narrow(&parser->arena, wname, wcslen(wname), &parser->wide->scratch, &parser->wide->scratch_cap);
+        if (!name) {
+            return arg_fail(result, ARG_ERROR_NO_MEMORY, result->positional_first, 0, -1);
+        }
+    } else {
+        name = result->argv[result->positional_first];
+    }
+    int k = commands->index[arg_command_slot(commands, name, strlen(name))];
+    if (k == ARG_INDEX_EMPTY) {
+        return arg_fail(result, ARG_ERROR_UNKNOWN_COMMAND, result->positional_first, 0, -1);
+    }
+    arg_parser_t *child = arg_command_child(parser, k);
+    if (!child) {
+        return arg_fail(result, ARG_ERROR_COMMAND_FAILED, result->positional_first, 0, -1);
+    }
+    commands->active = k;
+    /* The child reports its own errors. */
+    if (parser->wargv) {
+        return arg_parser_parse_w(child, result->positional_count, parser->wargv + result->positional_first) ? 1 : -1;
+    }
+    return arg_parser_parse(child, result->positional_count, result->argv + result->positional_first) ? 1 : -1;
+}
+
+const char* arg_parser_get_command(arg_parser_t *parser) {
+    const struct arg_commands *commands = parser->commands;
+    return commands && commands->active >= 0 ? commands->list[commands->active].name : NULL;
+}
+
+arg_parser_t* arg_parser_get_command_parser(arg_parser_t *parser) {
+    const struct arg_commands *commands = parser->commands;
+    return commands && commands->active >= 0 ? commands->list[commands->active].child : NULL;
+}
+
+static int arg_wide_render(arg_parser_t *parser, arg_text_t *text);
+
+/* Sends the message for the parser's recorded error to its sink. */
+static void arg_parser_report(arg_parser_t *parser) {
+    if (!parser->wargv) {
+        arg_report(&parser->schema, &parser->result);
+        return;
+    }
+    char storage[256];
+    arg_text_t text;
+    arg_text_init(&text, storage, sizeof(storage), false);
+    arg_wide_render(parser, &text);
+    arg_output(&parser->schema, ARG_OUTPUT_ERROR, &text);
+    arg_text_free(&text);
+}
+
+/* Completes a parse that scanned `argv` with outcome `ok`: fallbacks, subcommands and reporting. */
+static int arg_parser_settle(arg_parser_t *parser, int ok) {
+    /* Required arguments may still come from the environment or the config file. */
+    while (!ok && parser->fallbacks && parser->result.error.code == ARG_ERROR_MISSING_REQUIRED &&
+           arg_fallback_sets(parser, parser->result.error.id)) {
+        int missing = arg_next_missing(&parser->schema, &parser->result, parser->result.error.id + 1);
+        if (missing < 0) {
+            arg_error_clear(&parser->result.error);
+            ok = 1;
+        } else {
+            parser->result.error.id = missing;
+        }
+    }
+    if (ok && parser->commands) {
+        ok = arg_command_dispatch(parser);
+        if (ok < 0) {
+            return 0;
+        }
+    }
+    if (!ok) {
+        arg_parser_report(parser);
+    }
+    return ok;
+}
+
+int arg_parser_parse(arg_parser_t *parser, int argc, char *argv[]) {
+    ARG_STATS_BEGIN(parser);
+    ARG_TIMER(start);
+    /* Arguments may still be added between parses, so refresh the sorted index if needed. */
+    if (parser->schema.sorted && parser->schema.sorted_for != parser->schema.count) {
+        arg_sorted_build(&parser->schema);
+    }
+    parser->wargv = NULL;
+    arg_parser_drop_responses(parser);
+    int first = 1;
+    while (first < argc && argv[first][0] != '@') {
+        first++;
+    }
+    int ok;
+    if (first >= argc) {
+        ok = arg_schema_parse(&parser->schema, &parser->result, argc, argv);
+    } else {
+        int count = 0;
+        ok = 1;
+        for (int i = 0; i < argc && ok; i++) {
+            ok = i < first ? arg_push_token(parser, &count, argv[i]) : arg_expand_token(parser, &count, argv[i], 0);
+            if (!ok) {
+                arg_result_forget(&parser->schema, &parser->result);
+                parser->result.argv = argv;
+                parser->result.argc = argc;
+                arg_fail(&parser->result, ARG_ERROR_NO_MEMORY, i, 0, -1);
+            }
+        }
+        if (ok) {
+            ok = arg_schema_parse(&parser->schema, &parser->result, count, parser->tokens);
+        }
+    }
+    ok = arg_parser_settle(parser, ok);
+    ARG_TIMER_ADD(&parser->stats, parse_ns, start);
+    return ok;
+}
+
+/*
+ * Streaming. Tokens are parsed as they are fed, with the same rules as
+ * `arg_schema_parse`. Only tokens that results can refer to are kept: values,
+ * positionals, options carrying or awaiting a value, and a token that failed.
+ * They are copied into blocks that later streams reuse, and their pointers go
+ * in `parser->tokens`, which the result indexes as its `argv`; entry 0 stands
+ * in for the program name.
+ */
+
+#define ARG_STREAM_BLOCK 4096
+
+struct arg_stream_block {
+    struct arg_stream_block *next;
+    size_t size;                /* Bytes of text the block has room for */
+    size_t used;
+};
+
+#define ARG_STREAM_BLOCK_HEADER ARG_ARENA_ROUND(sizeof(struct arg_stream_block))
+
+struct arg_stream {
+    struct arg_stream_block *blocks;  /* Token storage, rewound by every `arg_parser_begin` */
+    struct arg_stream_block *current; /* Block the next copy goes into */
+    int count;                  /* Tokens kept, including entry 0 */
+    int first;                  /* Index of the first positional */
+    int positionals;            /* Positionals kept so far; they end at `count` */
+    int pending;                /* Argument whose value is the next token, or -1 */
+    int pending_index;          /* Index of the option token `pending` came from */
+    bool open;                  /* Whether tokens are accepted */
+    bool ended;                 /* Whether every further token is positional */
+};
+
+static char arg_stream_program[] = "";
+
+/* Copies a token into the stream's blocks, reusing blocks from earlier streams. */
+static char* arg_stream_copy(arg_parser_t *parser, struct arg_stream *stream, const char *token, size_t len) {
+    struct arg_stream_block *block = stream->current;
+    while (block && block->size - block->used <= len) {
+        block = block->next;
+        if (block) {
+            block->used = 0;
+        }
+    }
+    if (!block) {
+        size_t size = len + 1 > ARG_STREAM_BLOCK ? len + 1 : ARG_STREAM_BLOCK;
+        block = (struct arg_stream_block *)arg_arena_alloc(&parser->arena, ARG_STREAM_BLOCK_HEADER + size);
+        if (!block) {
+            return NULL;
+        }
+        block->size = size;
+        block->used = 0;
+        /* Link it after the current block so it is reused from there too. */
+        if (stream->current) {
+            block->next = stream->current->next;
+            stream->current->next = block;
+        } else {
+            block->next = stream->blocks;
+            stream->blocks = block;
+        }
+    }
+    stream->current = block;
+    char *copy = (char *)block + ARG_STREAM_BLOCK_HEADER + block->used;
+    memcpy(copy, token, len);
+    copy[len] = '\0';
+    block->used += len + 1;
+    return copy;
+}
+
+/* Forgets the last kept token, whose copy is always the latest one. */
+static void arg_stream_drop(arg_parser_t *parser, struct arg_stream *stream) {
+    const char *token = parser->tokens[--stream->count];
+    stream->current->used = (size_t)(token - ((char *)stream->current + ARG_STREAM_BLOCK_HEADER));
+    parser->result.argc = stream->count;
+}
+
+int arg_parser_begin(arg_parser_t *parser) {
+    ARG_STATS_BEGIN(parser);
+    ARG_TIMER(start);
+    if (parser->schema.sorted && parser->schema.sorted_for != parser->schema.count) {
+        arg_sorted_build(&parser->schema);
+    }
+    parser->wargv = NULL;
+    struct arg_stream *stream = parser->stream;
+    if (!stream) {
+        stream = (struct arg_stream *)arg_arena_alloc(&parser->arena, sizeof(struct arg_stream));
+        if (!stream) {
+            return 0;
+        }
+        stream->blocks = NULL;
+        parser->stream = stream;
+    }
+    stream->current = stream->blocks;
+    if (stream->current) {
+        stream->current->used = 0;
+    }
+    stream->count = 0;
+    stream->positionals = 0;
+    stream->pending = -1;
+    stream->ended = false;
+    stream->open = arg_push_token(parser, &stream->count, arg_stream_program);
+    arg_result_t *result = &parser->result;
+    arg_result_forget(&parser->schema, result);
+    result->argv = parser->tokens;
+    result->argc = stream->count;
+    arg_error_clear(&result->error);
+    arg_items_begin(&parser->schema, result);
+    ARG_TIMER_ADD(&parser->stats, parse_ns, start);
+    return stream->open;
+}
+
+/* Closes the stream on an error recorded for the token being fed, and reports it. */
+static int arg_stream_fail(arg_parser_t *parser, struct arg_stream *stream) {
+    stream->open = false;
+    arg_parser_report(parser);
+    return 0;
+}
+
+static int arg_stream_feed(arg_parser_t *parser, const char *token, size_t len) {
+    struct arg_stream *stream = parser->stream;
+    if (!stream || !stream->open) {
+        return 0;
+    }
+    const arg_schema_t *schema = &parser->schema;
+    arg_result_t *result = &parser->result;
+    char *copy = arg_stream_copy(parser, stream, token, len);
+    int i = stream->count;
+    if (!copy || !arg_push_token(parser, &stream->count, copy)) {
+        arg_fail(result, ARG_ERROR_NO_MEMORY, -1, 0, -1);
+        return arg_stream_fail(parser, stream);
+    }
+    result->argv = parser->tokens;
+    result->argc = stream->count;
+
+    if (stream->pending >= 0) {
+        int j = stream->pending;
+        stream->pending = -1;
+        if (!arg_store_value(schema, result, NULL, j, i, 0)) {
+            return arg_stream_fail(parser, stream);
+        }
+        if (stream->positionals) {
+            arg_hoist_option(result, NULL, &stream->first, stream->positionals, stream->pending_index, i + 1, j);
+        }
+        return 1;
+    }
+    if (!stream->ended) {
+        size_t eq;
+        unsigned int cls = arg_classify(copy, &len, &eq);
+        ARG_STAT(result->stats, tokens, 1);
+        if (cls & ARG_TOKEN_END) {
+            stream->ended = true;
+            arg_stream_drop(parser, stream);
+            return 1;
+        }
+        int valued = -1;
+        int status = (cls & ARG_TOKEN_DASH) || schema->dashless ? arg_parse_option(schema, result, NULL, &i, len, eq, cls, &valued, &stream->pending) : -1;
+        if (status == 0) {
+            return arg_stream_fail(parser, stream);
+        }
+        if (status > 0) {
+            if (stream->pending >= 0) {
+                /* Moved in front of the positionals once its value arrives. */
+                stream->pending_index = i;
+            } else if (valued >= 0 && result->values[valued].index == i) {
+                if (stream->positionals) {
+                    arg_hoist_option(result, NULL, &stream->first, stream->positionals, i, i + 1, valued);
+                }
+            } else {
+                arg_stream_drop(parser, stream);
+            }
+            return 1;
+        }
+        if ((cls & ARG_TOKEN_DASH) && len > 1) {
+            arg_fail(result, ARG_ERROR_UNRECOGNIZED, i, 0, -1);
+            return arg_stream_fail(parser, stream);
+        }
+        /* A subcommand name ends option parsing, as in `arg_schema_parse`. */
+        stream->ended = schema->commands;
+    }
+    if (!stream->positionals) {
+        stream->first = i;
+    }
+    stream->positionals++;
+    return 1;
+}
+
+int arg_parser_feed(arg_parser_t *parser, const char *token, size_t len) {
+    ARG_TIMER(start);
+    int ok = arg_stream_feed(parser, token, len);
+    ARG_TIMER_ADD(&parser->stats, parse_ns, start);
+    return ok;
+}
+
+int arg_parser_finish(arg_parser_t *parser) {
+    struct arg_stream *stream = parser->stream;
+    if (!stream || !stream->open) {
+        return 0;
+    }
+    ARG_TIMER(start);
+    stream->open = false;
+    const arg_schema_t *schema = &parser->schema;
+    arg_result_t *result = &parser->result;
+    int ok = 1;
+    if (stream->pending >= 0) {
+        if (arg_bit_test(schema->required, stream->pending)) {
+            ok = arg_fail(result, ARG_ERROR_MISSING_VALUE, stream->pending_index, 0, stream->pending);
+        } else if (stream->positionals) {
+            arg_hoist_option(result, NULL, &stream->first, stream->positionals, stream->pending_index, stream->pending_index + 1, -1);
+        }
+    }
+    result->positional_first = stream->positionals ? stream->first : stream->count;
+    result->positional_count = stream->positionals;
+    arg_items_group(result);
+    if (ok) {
+        int missing = arg_next_missing(schema, result, 0);
+        if (missing >= 0) {
+            ok = arg_fail(result, ARG_ERROR_MISSING_REQUIRED, -1, 0, missing);
+        }
+    }
+    ok = arg_parser_settle(parser, ok);
+    ARG_TIMER_ADD(&parser->stats, parse_ns, start);
+    return ok;
+}
+
+/*
+ * Wide parsing. The schema's names are encoded as wide strings once, on the
+ * first wide parse after the schema changes, and wide tokens are matched
+ * against them without being narrowed: they probe the shared hash index with
+ * the hash of their UTF-8 form, and abbreviations search the shared sorted
+ * index. Only typed values are narrowed while parsing; other values are
+ * narrowed when an accessor returns them as `char` strings.
+ */
+
+/* `arg_name_hash` of the UTF-8 form of `name[0..len)`, so wide names land on the same slots. */
+static unsigned int arg_wide_hash(const wchar_t *name, size_t len) {
+    unsigned int hash = 2166136261u;
+    char buf[4];
+    for (size_t pos = 0; pos < len;) {
+        size_t n = arg_utf8_encode(arg_wide_decode(name, len, &pos), buf);
+        for (size_t k = 0; k < n; k++) {
+            hash ^= (unsigned char)buf[k];
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+static bool arg_wide_slot_matches(const struct arg_wide *wide, int slot, const wchar_t *name, size_t len) {
+    const struct arg_wide_key *key = &wide->keys[slot >> 1];
+    if (slot & 1) {
+        return key->long_len == len && wmemcmp(key->long_name, name, len) == 0;
+    }
+    return key->short_len == len && wmemcmp(key->short_name, name, len) == 0;
+}
+
+/* Like `arg_index_find_n`, on the first `len` units of a wide name. */
+static int arg_wide_find(const arg_schema_t *schema, struct arg_wide *wide, const wchar_t *name, size_t len ARG_STATS_PARAM) {
+    if (schema->lookup) {
+        /* A generated matcher takes UTF-8, and nothing longer than the longest name can match. */
+        size_t bytes = arg_wide_narrow_into(name, len, NULL);
+        ARG_STAT(stats, probes, 1);
+        if (bytes > wide->name_cap) {
+            return -1;
+        }
+        arg_wide_narrow_into(name, len, wide->name);
+        return schema->lookup(wide->name, bytes);
+    }
+    if (!schema->index) {
+        return -1;
+    }
+    unsigned int size = (unsigned int)schema->index_size;
+    for (unsigned int pos = arg_wide_hash(name, len) % size;; pos = pos + 1 == size ? 0 : pos + 1) {
+        int slot = schema->index[pos];
+        ARG_STAT(stats, probes, 1);
+        if (slot == ARG_INDEX_EMPTY) {
+            return -1;
+        }
+        ARG_STAT(stats, compares, 1);
+        if (arg_wide_slot_matches(wide, slot, name, len)) {
+            return slot >> 1;
+        }
+    }
+}
+
+/* Encodes a name into `*pool`, advancing it; NULL stays NULL. */
+static const wchar_t* arg_wide_encode(const char *name, size_t len, wchar_t **pool, uint16_t *wide_len) {
+    if (!name) {
+        *wide_len = 0;
+        return NULL;
+    }
+    wchar_t *start = *pool;
+    wchar_t *out = start;
+    for (size_t pos = 0; pos < len;) {
+        uint32_t c = arg_utf8_decode(name, len, &pos);
+#ifdef ARG_WIDE_UTF16
+        if (c >= 0x10000) {
+            *out++ = (wchar_t)(0xd800 + ((c - 0x10000) >> 10));
+            c = 0xdc00 + ((c - 0x10000) & 0x3ff);
+        }
+#endif
+        *out++ = (wchar_t)c;
+    }
+    *out++ = L'\0';
+    *pool = out;
+    *wide_len = (uint16_t)(out - start - 1);
+    return start;
+}
+
+/* Creates the wide state, encodes the names if arguments were added, and sizes the value cache. */
+static struct arg_wide* arg_wide_fit(arg_parser_t *parser) {
+    arg_arena_t *arena = &parser->arena;
+    const arg_schema_t *schema = &parser->schema;
+    struct arg_wide *wide = parser->wide;
+    if (!wide) {
+        wide = (struct arg_wide *)arg_arena_alloc(arena, sizeof(struct arg_wide));
+        if (!wide) {
+            return NULL;
+        }
+        memset(wide, 0, sizeof(struct arg_wide));
+        wide->arena = arena;
+        wide->count = -1;
+        parser->wide = wide;
+    }
+    int n = schema->count;
+    if (wide->count != n) {
+        /* UTF-8 never takes fewer bytes than the wide form takes units. */
+        size_t units = 0;
+        size_t longest = 0;
+        for (int i = 0; i < n; i++) {
+            const arg_key_t *key = &schema->keys[i];
+            units += (size_t)key->short_len + key->long_len + 2;
+            longest = key->short_len > longest ? key->short_len : longest;
+            longest = key->long_len > longest ? key->long_len : longest;
+        }
+        struct arg_wide_key *keys = (struct arg_wide_key *)arg_arena_alloc(arena, sizeof(struct arg_wide_key) * (n ? n : 1));
+        wchar_t *pool = (wchar_t *)arg_arena_alloc(arena, sizeof(wchar_t) * (units ? units : 1));
+        char *name = schema->lookup ? (char *)arg_arena_alloc(arena, longest + 1) : NULL;
+        if (!keys || !pool || (schema->lookup && !name)) {
+            return NULL;
+        }
+        for (int i = 0; i < n; i++) {
+            const arg_key_t *key = &schema->keys[i];
+            keys[i].short_name = arg_wide_encode(arg_schema_string(schema, key->short_name), key->short_len, &pool, &keys[i].short_len);
+            keys[i].long_name = arg_wide_encode(arg_schema_string(schema, key->long_name), key->long_len, &pool, &keys[i].long_len);
+        }
+        wide->keys = keys;
+        wide->name = name;
+        wide->name_cap = longest;
+        wide->count = n;
+    }
+    if (n > wide->capacity) {
+        int capacity = n > 2 * wide->capacity ? n : 2 * wide->capacity;
+        char **values = (char **)arg_arena_alloc(arena, sizeof(char *) * capacity);
+        size_t *caps = (size_t *)arg_arena_alloc(arena, sizeof(size_t) * capacity);
+        uint64_t *converted = (uint64_t *)arg_arena_alloc(arena, sizeof(uint64_t) * ARG_BITSET_WORDS(capacity));
+        if (!values || !caps || !converted) {
+            return NULL;
+        }
+        memset(values, 0, sizeof(char *) * capacity);
+        memset(caps, 0, sizeof(size_t) * capacity);
+        if (wide->capacity) {
+            memcpy(values, wide->values, sizeof(char *) * wide->capacity);
+            memcpy(caps, wide->value_caps, sizeof(size_t) * wide->capacity);
+        }
+        wide->values = values;
+        wide->value_caps = caps;
+        wide->converted = converted;
+        wide->capacity = capacity;
+    }
+    if (wide->capacity) {
+        memset(wide->converted, 0, sizeof(uint64_t) * ARG_BITSET_WORDS(wide->capacity));
+    }
+    return wide;
+}
+
+/* Compares in code point order, which for UTF-16 means moving surrogates above U+FFFF's neighbours. */
+static uint32_t arg_wide_order(wchar_t c) {
+    uint32_t u = (uint32_t)c;
+#ifdef ARG_WIDE_UTF16
+    u &= 0xffff;
+    if (u >= 0xd800) {
+        u = u >= 0xe000 ? u - 0x800 : u + 0x2000;
+    }
+#endif
+    return u;
+}
+
+static int arg_wide_name_cmp(const wchar_t *a, size_t a_len, const wchar_t *b, size_t b_len) {
+    size_t n = a_len < b_len ? a_len : b_len;
+    for (size_t k = 0; k < n; k++) {
+        if (a[k] != b[k]) {
+            return arg_wide_order(a[k]) < arg_wide_order(b[k]) ? -1 : 1;
+        }
+    }
+    return a_len < b_len ? -1 : a_len > b_len;
+}
+
+static bool arg_wide_has_prefix(const struct arg_wide_key *key, const wchar_t *prefix, size_t len) {
+    return key->long_len >= len && wmemcmp(key->long_name, prefix, len) == 0;
+}
+
+/* Like `arg_sorted_find_prefix`, over the wide names in the shared sorted order. */
+static int arg_wide_find_prefix(const arg_schema_t *schema, const struct arg_wide *wide, const wchar_t *name, size_t len ARG_STATS_PARAM) {
+    if (!schema->sorted || schema->sorted_for != schema->count || len <= 2) {
+        return -1;
+    }
+    int lo = 0;
+    int hi = schema->sorted_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        const struct arg_wide_key *key = &wide->keys[schema->sorted[mid]];
+        ARG_STAT(stats, compares, 1);
+        if (arg_wide_name_cmp(key->long_name, key->long_len, name, len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == schema->sorted_count) {
+        return -1;
+    }
+    ARG_STAT(stats, compares, 1);
+    if (!arg_wide_has_prefix(&wide->keys[schema->sorted[lo]], name, len)) {
+        return -1;
+    }
+    if (lo + 1 < schema->sorted_count) {
+        ARG_STAT(stats, compares, 1);
+        if (arg_wide_has_prefix(&wide->keys[schema->sorted[lo + 1]], name, len)) {
+            return ARG_PREFIX_AMBIGUOUS;
+        }
+    }
+    return schema->sorted[lo];
+}
+
+/* Like `arg_classify`, on a wide token; lengths count `wchar_t` units. */
+static unsigned int arg_wide_classify(const wchar_t *token, size_t *len, size_t *eq) {
+    *len = wcslen(token);
+    *eq = *len;
+    if (token[0] != L'-') {
+        return 0;
+    }
+    if (token[1] != L'-') {
+        return ARG_TOKEN_DASH;
+    }
+    if (*len == 2) {
+        return ARG_TOKEN_DASH | ARG_TOKEN_LONG | ARG_TOKEN_END;
+    }
+    const wchar_t *equals = wmemchr(token + 2, L'=', *len - 2);
+    if (equals) {
+        *eq = (size_t)(equals - token);
+    }
+    return ARG_TOKEN_DASH | ARG_TOKEN_LONG | (equals ? ARG_TOKEN_EQ : 0u);
+}
+
+/*
+ * Text for `arg_convert` of a value of type `type`: typed values are narrowed,
+ * whatever their length, into the scratch buffer, which later parses reuse.
+ * Other types need no text. NULL if the buffer could not grow.
+ */
+static const char* arg_wide_typed_text(struct arg_wide *wide, uint8_t type, const wchar_t *text) {
+    if (type < ARG_TYPE_INT || type > ARG_TYPE_DURATION) {
+        return "";
+    }
+    return arg_wide_narrow(wide->arena, text, wcslen(text), &wide->scratch, &wide->scratch_cap);
+}
+
+int arg_parser_parse_w(arg_parser_t *parser, int argc, wchar_t *argv[]) {
+    ARG_STATS_BEGIN(parser);
+    ARG_TIMER(start);
+    if (parser->schema.sorted && parser->schema.sorted_for != parser->schema.count) {
+        arg_sorted_build(&parser->schema);
+    }
+    parser->wargv = argv;
+    int ok;
+    struct arg_wide *wide = arg_wide_fit(parser);
+    if (!wide) {
+        /* Without the wide state there is no way to narrow tokens for the message either. */
+        parser->wargv = NULL;
+        arg_result_forget(&parser->schema, &parser->result);
+        parser->result.argv = NULL;
+        parser->result.argc = 0;
+        ok = arg_fail(&parser->result, ARG_ERROR_NO_MEMORY, -1, 0, -1);
+    } else {
+        wide->argv = argv;
+        ok = arg_scan_vector(&parser->schema, &parser->result, argc, NULL, wide);
+    }
+    ok = arg_parser_settle(parser, ok);
+    ARG_TIMER_ADD(&parser->stats, parse_ns, start);
+    return ok;
+}
+
+/*
+ * Renders the recorded error of a wide parse. The message is built by the
+ * narrow renderer from a view of the result holding just the offending token,
+ * narrowed, with its offset converted to bytes.
+ */
+static int arg_wide_render(arg_parser_t *parser, arg_text_t *text) {
+    arg_result_t view = parser->result;
+    char *token = NULL;
+    if (view.error.index >= 0 && view.error.index < view.argc) {
+        const wchar_t *wtoken = parser->wargv[view.error.index];
+        struct arg_wide *wide = parser->wide;
+        token = arg_wide_narrow(&parser->arena, wtoken, wcslen(wtoken), &wide->scratch, &wide->scratch_cap);
+        view.error.offset = (int)arg_wide_narrow_into(wtoken, (size_t)view.error.offset, NULL);
+    }
+    view.argv = &token;
+    view.argc = token ? 1 : 0;
+    view.error.index = token ? 0 : -1;
+    arg_error_render(&parser->schema, &view, text);
+    return 1;
+}
+
+/* UTF-8 copy of argument `i`'s value from the last wide parse, converted once per parse. */
+static const char* arg_wide_value(arg_parser_t *parser, int i) {
+    if (!arg_result_has_value(&parser->result, i)) {
+        return NULL;
+    }
+    struct arg_wide *wide = parser->wide;
+    if (!arg_bit_test(wide->converted, i)) {
+        arg_ref_t ref = parser->result.values[i];
+        const wchar_t *value = parser->wargv[ref.index] + ref.offset;
+        if (!arg_wide_narrow(&parser->arena, value, wcslen(value), &wide->values[i], &wide->value_caps[i])) {
+            return NULL;
+        }
+        arg_bit_set(wide->converted, i);
+    }
+    return wide->values[i];
+}
+
+const wchar_t* arg_parser_get_value_w(arg_parser_t *parser, arg_id_t id) {
+    if (!parser->wargv || id < 0 || id >= parser->schema.count || !arg_result_has_value(&parser->result, id)) {
+        return NULL;
+    }
+    arg_ref_t ref = parser->result.values[id];
+    return parser->wargv[ref.index] + ref.offset;
+}
+
+/* Finds the argument called `name` for an accessor. */
+static int arg_parser_lookup(arg_parser_t *parser, const char *name) {
+    ARG_TIMER(start);
+    int i = name ? arg_index_find_n(&parser->schema, name, strlen(name) ARG_STATS_PASS(&parser->stats)) : -1;
+    ARG_TIMER_ADD(&parser->stats, lookup_ns, start);
+    return i;
+}
+
+/* Value of argument `i` from argv, or else from its fallbacks. */
+static const char* arg_parser_value_at(arg_parser_t *parser, int i) {
+    const char *value = parser->wargv ? arg_wide_value(parser, i) : arg_result_value_at(&parser->result, i);
+    if (!value && parser->fallbacks && parser->schema.keys[i].type != ARG_TYPE_FLAG) {
+        value = arg_fallback_value(parser, i);
+    }
+    return value;
+}
+
+/* Whether argument `i` was set on argv, or else by its fallbacks. */
+static bool arg_parser_set_at(arg_parser_t *parser, int i) {
+    if (arg_bit_test(parser->result.set, i)) {
+        return true;
+    }
+    return parser->fallbacks && arg_fallback_sets(parser, i);
+}
+
+const char* arg_parser_get_value(arg_parser_t *parser, const char *name) {
+    int i = arg_parser_lookup(parser, name);
+    return i < 0 ? NULL : arg_parser_value_at(parser, i);
+}
+
+bool arg_parser_is_flag_set(arg_parser_t *parser, const char *name) {
+    int i = arg_parser_lookup(parser, name);
+    return i < 0 ? false : arg_parser_set_at(parser, i);
+}
+
+arg_id_t arg_parser_find(arg_parser_t *parser, const char *name) {
+    return arg_parser_lookup(parser, name);
+}
+
+const char* arg_parser_get_value_id(arg_parser_t *parser, arg_id_t id) {
+    if (id < 0 || id >= parser->schema.count) {
+        return NULL;
+    }
+    return arg_parser_value_at(parser, id);
+}
+
+arg_view_t arg_parser_get_view_id(arg_parser_t *parser, arg_id_t id) {
+    arg_view_t view = { NULL, 0 };
+    view.data = arg_parser_get_value_id(parser, id);
+    view.len = view.data ? strlen(view.data) : 0;
+    return view;
+}
+
+bool arg_parser_is_set_id(arg_parser_t *parser, arg_id_t id) {
+    if (id < 0 || id >= parser->schema.count) {
+        return false;
+    }
+    return arg_parser_set_at(parser, id);
+}
+
+const arg_value_t* arg_parser_get_typed_id(arg_parser_t *parser, arg_id_t id) {
+    if (id < 0 || id >= parser->schema.count) {
+        return NULL;
+    }
+    const arg_value_t *value = arg_result_get_typed_id(&parser->schema, &parser->result, id);
+    uint8_t type = parser->schema.keys[id].type;
+    if (!value && parser->fallbacks && type > ARG_TYPE_VALUE && type != ARG_TYPE_LIST && arg_fallback_value(parser, id)) {
+        value = &parser->fallback->typed[id];
+    }
+    return value;
+}
+
+/* Converted value of the argument called `name` if it has `type` and a value. */
+static const arg_value_t* arg_parser_typed(arg_parser_t *parser, const char *name, arg_type_t type) {
+    int i = arg_parser_lookup(parser, name);
+    if (i < 0 || parser->schema.keys[i].type != type) {
+        return NULL;
+    }
+    return arg_parser_get_typed_id(parser, i);
+}
+
+int64_t arg_parser_get_int(arg_parser_t *parser, const char *name, int64_t fallback) {
+    const arg_value_t *value = arg_parser_typed(parser, name, ARG_TYPE_INT);
+    return value ? value->i : fallback;
+}
+
+double arg_parser_get_double(arg_parser_t *parser, const char *name, double fallback) {
+    const arg_value_t *value = arg_parser_typed(parser, name, ARG_TYPE_DOUBLE);
+    return value ? value->d : fallback;
+}
+
+uint64_t arg_parser_get_size(arg_parser_t *parser, const char *name, uint64_t fallback) {
+    const arg_value_t *value = arg_parser_typed(parser, name, ARG_TYPE_SIZE);
+    return value ? value->size : fallback;
+}
+
+int64_t arg_parser_get_duration(arg_parser_t *parser, const char *name, int64_t fallback) {
+    const arg_value_t *value = arg_parser_typed(parser, name, ARG_TYPE_DURATION);
+    return value ? value->ns : fallback;
+}
+
+const arg_ref_t* arg_parser_get_values(arg_parser_t *parser, arg_id_t id, int *count) {
+    return arg_result_get_values(&parser->schema, &parser->result, id, count);
+}
+
+#ifdef TINYARGS_STATS
+const arg_stats_t* arg_parser_get_stats(arg_parser_t *parser) {
+    return &parser->stats;
+}
+
+void arg_parser_set_match_hook(arg_parser_t *parser, arg_match_fn fn, void *ctx) {
+    parser->result.on_match = fn;
+    parser->result.match_ctx = ctx;
+}
+#endif
+
+const arg_error_t* arg_parser_get_error(arg_parser_t *parser) {
+    return &parser->result.error;
+}
+
+size_t arg_parser_format_error(arg_parser_t *parser, char *buf, size_t size) {
+    if (!parser->wargv) {
+        return arg_result_format_error(&parser->schema, &parser->result, buf, size);
+    }
+    arg_text_t text;
+    arg_text_init(&text, buf, size, true);
+    arg_wide_render(parser, &text);
+    return text.len;
+}
+
+arg_span_t arg_parser_get_positionals(arg_parser_t *parser) {
+    return arg_result_get_positionals(&parser->result);
+}
+
+bool arg_parser_has(arg_parser_t *parser, const char *name) {
+    int i = arg_parser_lookup(parser, name);
+    if (i < 0) {
+        return false;
+    }
+    if (parser->schema.keys[i].type == ARG_TYPE_FLAG) {
+        return arg_parser_set_at(parser, i);
+    }
+    return arg_parser_value_at(parser, i) != NULL;
+}
+
+static const char *const arg_type_names[] = {
+    "Flag", "Key=Value", "Integer", "Number", "Size", "Duration", "List"
+};
+
+/* Names wider than this start their description on the next line. */
+#define ARG_HELP_NAME_MAX 32
+
+static size_t arg_help_name_width(const arg_key_t *key, size_t short_width) {
+    if (!key->long_name) {
+        return 2 + key->short_len;
+    }
+    return 2 + short_width + (short_width ? 2 : 0) + key->long_len;
+}
+
+/* Appends `word` on the current line, or on a new one indented by `indent` if it would not fit. */
+static void arg_help_word(arg_text_t *text, const char *word, size_t len, size_t *column, size_t indent) {
+    if (*column > indent && *column + 1 + len > ARG_HELP_WIDTH) {
+        arg_text_append(text, "\n", 1);
+        arg_text_pad(text, indent);
+        *column = indent;
+    } else if (*column > indent) {
+        arg_text_append(text, " ", 1);
+        (*column)++;
+    }
+    arg_text_append(text, word, len);
+    *column += len;
+}
+
+/* Appends `words` word-wrapped to ARG_HELP_WIDTH. */
+static void arg_help_wrap(arg_text_t *text, const char *words, size_t *column, size_t indent) {
+    const char *p = words;
+    for (;;) {
+        while (*p == ' ') {
+            p++;
+        }
+        const char *word = p;
+        while (*p && *p != ' ') {
+            p++;
+        }
+        if (p == word) {
+            return;
+        }
+        arg_help_word(text, word, (size_t)(p - word), column, indent);
+    }
+}
+
+static void arg_help_render(const arg_schema_t *schema, const struct arg_commands *commands, arg_text_t *text) {
+    size_t short_width = 0;
+    for (int i = 0; i < schema->count; i++) {
+        if (schema->keys[i].short_len > short_width) {
+            short_width = schema->keys[i].short_len;
+        }
+    }
+    size_t name_width = 0;
+    for (int i = 0; i < schema->count; i++) {
+        size_t width = arg_help_name_width(&schema->keys[i], short_width);
+        if (width <= ARG_HELP_NAME_MAX && width > name_width) {
+            name_width = width;
+        }
+    }
+    size_t indent = name_width + 2;
+
+    arg_text_append(text, "Usage:\n", 7);
+    for (int i = 0; i < schema->count; i++) {
+        const arg_t *arg = &schema->args[i];
+        const arg_key_t *key = &schema->keys[i];
+        if (!key->short_name && !key->long_name) {
+            continue;
+        }
+        arg_text_pad(text, 2);
+        const char *short_name = arg_schema_string(schema, key->short_name);
+        if (key->long_name) {
+            if (short_name) {
+                arg_text_append(text, short_name, key->short_len);
+                arg_text_append(text, ", ", 2);
+                arg_text_pad(text, short_width - key->short_len);
+            } else {
+                arg_text_pad(text, short_width + (short_width ? 2 : 0));
+            }
+            arg_text_append(text, arg_schema_string(schema, key->long_name), key->long_len);
+        } else {
+            arg_text_append(text, short_name, key->short_len);
+        }
+        size_t column = arg_help_name_width(key, short_width);
+        if (column > name_width) {
+            arg_text_append(text, "\n", 1);
+            column = 0;
+        }
+        arg_text_pad(text, indent - column);
+        column = indent;
+        if (arg->description) {
+            arg_help_wrap(text, arg_schema_string(schema, arg->description), &column, indent);
+        }
+        /* The type tag is kept on one line. */
+        char type[32];
+        int type_len = snprintf(type, sizeof(type), "(Type: %s)", arg_type_names[arg->type]);
+        arg_help_word(text, type, (size_t)type_len, &column, indent);
+        arg_text_append(text, "\n", 1);
+    }
+    if (!commands || !commands->count) {
+        return;
+    }
+
+    size_t command_width = 0;
+    for (int k = 0; k < commands->count; k++) {
+        if (commands->list[k].name_len <= ARG_HELP_NAME_MAX && commands->list[k].name_len > command_width) {
+            command_width = commands->list[k].name_len;
+        }
+    }
+    indent = command_width + 4;
+    arg_text_append(text, "Commands:\n", 10);
+    for (int k = 0; k < commands->count; k++) {
+        const struct arg_command *command = &commands->list[k];
+        arg_text_pad(text, 2);
+        arg_text_append(text, command->name, command->name_len);
+        size_t column = command->name_len + 2;
+        if (column > indent - 2) {
+            arg_text_append(text, "\n", 1);
+            column = 0;
+        }
+        if (command->description) {
+            arg_text_pad(text, indent - column);
+            column = indent;
+            arg_help_wrap(text, command->description, &column, indent);
+        }
+        arg_text_append(text, "\n", 1);
+    }
+}
+
+/*
+ * Compiled schemas. The blob is a header followed by the argument table, the
+ * keys, the required bitset, both indexes, the help text and a string pool,
+ * each section aligned to ARG_ARENA_ALIGN. Name and description pointers are
+ * stored as offsets into the pool, 0 standing for NULL, and stay that way:
+ * the schema's `strings` points at the pool and `arg_schema_string` adds it
+ * on access, so the mapping is read-only and loading does no per-argument
+ * work beyond validation. The indexes hold argument positions only.
+ */
+
+#define ARG_IMAGE_MAGIC "tinyargs"
+#define ARG_IMAGE_VERSION 2u
+#define ARG_IMAGE_ORDER 0x01020304u
+#define ARG_IMAGE_DASHLESS 1u
+#define ARG_IMAGE_LISTS 2u
+#define ARG_IMAGE_ENV 4u
+
+struct arg_image {
+    char magic[8];
+    uint32_t version;
+    uint32_t order;             /* ARG_IMAGE_ORDER in the writer's byte order */
+    uint32_t layout;            /* Sizes of arg_t, arg_key_t and pointers on the writer */
+    uint32_t flags;             /* ARG_IMAGE_DASHLESS, ARG_IMAGE_LISTS, ARG_IMAGE_ENV */
+    int32_t count;
+    int32_t index_size;
+    int32_t sorted_count;
+    int32_t reserved;
+    uint64_t size;              /* Length of the whole blob */
+    uint64_t args;              /* Offsets of the sections */
+    uint64_t keys;
+    uint64_t required;
+    uint64_t index;
+    uint64_t sorted;
+    uint64_t help;
+    uint64_t help_len;
+    uint64_t strings;
+};
+
+#define ARG_IMAGE_LAYOUT ((uint32_t)(sizeof(arg_t) << 16 | sizeof(arg_key_t) << 8 | sizeof(void *)))
+
+/* Appends zero bytes up to the next section boundary. */
+static void arg_image_align(arg_text_t *text) {
+    static const char zeros[ARG_ARENA_ALIGN] = { 0 };
+    arg_text_append(text, zeros, ARG_ARENA_ROUND(text->len) - text->len);
+}
+
+/* Offset in the pool that `str` will get once appended, advancing `*pool`; NULL (offset 0) for NULL. */
+static const char* arg_image_string(const char *str, uint64_t *pool) {
+    if (!str) {
+        return NULL;
+    }
+    uint64_t offset = *pool;
+    *pool += strlen(str) + 1;
+    return (const char *)(uintptr_t)offset;
+}
+
+/* Appends a section, which is empty, and may be NULL, for an empty schema. */
+static void arg_image_append(arg_text_t *text, const void *data, size_t len) {
+    if (len) {
+        arg_text_append(text, (const char *)data, len);
+    }
+}
+
+static void arg_image_append_string(arg_text_t *text, const char *str) {
+    if (str) {
+        arg_text_append(text, str, strlen(str) + 1);
+    }
+}
+
+int arg_parser_compile_to(arg_parser_t *parser, const char *path) {
+    const arg_schema_t *schema = &parser->schema;
+    if ((parser->commands && parser->commands->count) || schema->lookup) {
+        return 0;
+    }
+    if (schema->sorted && schema->sorted_for != schema->count) {
+        arg_sorted_build(&parser->schema);
+    }
+    int n = schema->count;
+    char help_storage[4096];
+    arg_text_t help;
+    arg_text_init(&help, help_storage, sizeof(help_storage), false);
+    arg_help_render(schema, NULL, &help);
+
+    struct arg_image header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARG_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = ARG_IMAGE_VERSION;
+    header.order = ARG_IMAGE_ORDER;
+    header.layout = ARG_IMAGE_LAYOUT;
+    header.flags = (schema->dashless ? ARG_IMAGE_DASHLESS : 0) | (schema->lists ? ARG_IMAGE_LISTS : 0);
+    for (int i = 0; i < n; i++) {
+        if (schema->args[i].env) {
+            header.flags |= ARG_IMAGE_ENV;
+        }
+    }
+    header.count = n;
+    header.index_size = schema->index ? schema->index_size : 0;
+    header.sorted_count = schema->sorted ? schema->sorted_count : 0;
+    header.args = ARG_ARENA_ROUND(sizeof(header));
+    header.keys = header.args + ARG_ARENA_ROUND(sizeof(arg_t) * n);
+    header.required = header.keys + ARG_ARENA_ROUND(sizeof(arg_key_t) * n);
+    header.index = header.required + ARG_ARENA_ROUND(sizeof(uint64_t) * ARG_BITSET_WORDS(n));
+    header.sorted = header.index + ARG_ARENA_ROUND(sizeof(int) * header.index_size);
+    header.help = header.sorted + ARG_ARENA_ROUND(sizeof(int) * header.sorted_count);
+    header.help_len = help.len;
+    header.strings = header.help + ARG_ARENA_ROUND(help.len + 1);
+
+    char storage[4096];
+    arg_text_t blob;
+    arg_text_init(&blob, storage, sizeof(storage), false);
+    arg_text_append(&blob, (const char *)&header, sizeof(header));
+    arg_image_align(&blob);
+    /* The pool starts with a NUL so that no string sits at offset 0. */
+    uint64_t pool = 1;
+    for (int i = 0; i < n; i++) {
+        arg_t arg = schema->args[i];
+        arg.short_name = arg_image_string(arg_schema_string(schema, arg.short_name), &pool);
+        arg.long_name = arg_image_string(arg_schema_string(schema, arg.long_name), &pool);
+        arg.description = arg_image_string(arg_schema_string(schema, arg.description), &pool);
+        arg.env = arg_image_string(arg_schema_string(schema, arg.env), &pool);
+        arg_text_append(&blob, (const char *)&arg, sizeof(arg));
+    }
+    arg_image_align(&blob);
+    for (int i = 0; i < n; i++) {
+        /* The keys share the strings of the table. */
+        const arg_t *arg = (const arg_t *)(blob.data + header.args) + i;
+        arg_key_t key = schema->keys[i];
+        key.short_name = arg->short_name;
+        key.long_name = arg->long_name;
+        arg_text_append(&blob, (const char *)&key, sizeof(key));
+    }
+    arg_image_align(&blob);
+    arg_image_append(&blob, schema->required, sizeof(uint64_t) * ARG_BITSET_WORDS(n));
+    arg_image_align(&blob);
+    arg_image_append(&blob, schema->index, sizeof(int) * header.index_size);
+    arg_image_align(&blob);
+    arg_image_append(&blob, schema->sorted, sizeof(int) * header.sorted_count);
+    arg_image_align(&blob);
+    arg_text_append(&blob, help.data, help.len + 1);
+    arg_image_align(&blob);
+    arg_text_append(&blob, "", 1);
+    for (int i = 0; i < n; i++) {
+        const arg_t *arg = &schema->args[i];
+        arg_image_append_string(&blob, arg_schema_string(schema, arg->short_name));
+        arg_image_append_string(&blob, arg_schema_string(schema, arg->long_name));
+        arg_image_append_string(&blob, arg_schema_string(schema, arg->description));
+        arg_image_append_string(&blob, arg_schema_string(schema, arg->env));
+    }
+    int ok = blob.len < blob.cap && help.len < help.cap;
+    if (ok) {
+        ((struct arg_image *)blob.data)->size = blob.len;
+        FILE *file = fopen(path, "wb");
+        ok = file && fwrite(blob.data, 1, blob.len, file) == blob.len;
+        if (file && fclose(file) != 0) {
+            ok = 0;
+        }
+    }
+    arg_text_free(&blob);
+    arg_text_free(&help);
+    return ok;
+}
+
+/* Maps or reads the blob at `path` into `image`; false if it cannot be read. */
+static bool arg_image_load(arg_arena_t *arena, const char *path, struct arg_response *image, size_t *len) {
+    image->next = NULL;
+    image->data = NULL;
+    image->mapped = 0;
+    image->buffer = NULL;
+    image->buffer_cap = 0;
+#ifdef TINYARGS_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            image->data = (char *)data;
+            image->mapped = (size_t)st.st_size;
+            *len = (size_t)st.st_size;
+        }
+    }
+    close(fd);
+#endif
+    if (!image->data) {
+        FILE *file = fopen(path, "rb");
+        if (file) {
+            image->data = arg_response_read(arena, image, file, len);
+            fclose(file);
+        }
+    }
+    return image->data != NULL;
+}
+
+/* Whether `header` describes a blob of `len` bytes written by a compatible build. */
+static bool arg_image_valid(const struct arg_image *header, size_t len) {
+    if (len < sizeof(*header) || memcmp(header->magic, ARG_IMAGE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ARG_IMAGE_VERSION || header->order != ARG_IMAGE_ORDER ||
+        header->layout != ARG_IMAGE_LAYOUT || header->size != len || header->count < 0 ||
+        header->index_size < 0 || header->sorted_count < 0 || header->sorted_count > header->count) {
+        return false;
+    }
+    uint64_t n = (uint64_t)header->count;
+    const uint64_t sections[] = { header->args, header->keys, header->required, header->index, header->sorted,
+                                  header->help, header->strings };
+    for (size_t k = 0; k < sizeof(sections) / sizeof(sections[0]); k++) {
+        if (sections[k] % ARG_ARENA_ALIGN || sections[k] > len) {
+            return false;
+        }
+    }
+    /* Sections are laid out in order, so checking each end against the next start bounds them all. */
+    return header->args >= sizeof(*header) && header->keys >= header->args + sizeof(arg_t) * n &&
+           header->required >= header->keys + sizeof(arg_key_t) * n &&
+           header->index >= header->required + sizeof(uint64_t) * ARG_BITSET_WORDS(n) &&
+           header->sorted >= header->index + sizeof(int) * (uint64_t)header->index_size &&
+           header->help >= header->sorted + sizeof(int) * (uint64_t)header->sorted_count &&
+           header->help_len < len && header->strings >= header->help + header->help_len + 1 && header->strings < len &&
+           (header->index_size > (int)n || (n == 0 && header->index_size == 0)) &&
+           ((const char *)header)[len - 1] == '\0';
+}
+
+/*
+ * Whether a string field holds an offset inside the pool of `size` bytes. A
+ * name must also end after `len` bytes, so that comparing `len` bytes never
+ * reads past it; other strings end at the blob's final NUL at the latest.
+ */
+static bool arg_image_string_valid(const char *pool, uint64_t size, const char *field, size_t len, bool name) {
+    uint64_t offset = (uint64_t)(uintptr_t)field;
+    if (!offset) {
+        return !len;
+    }
+    if (offset >= size) {
+        return false;
+    }
+    return !name || (len < size - offset && pool[offset + len] == '\0');
+}
+
+/*
+ * Checks everything parsing and printing read from the tables of a blob whose
+ * header passed `arg_image_valid`: string offsets, name lengths, types, the
+ * required bits, index slots and sorted ids, and that the index has an empty
+ * slot to end every probe. Nothing is written, so the pages stay shared.
+ */
+static bool arg_image_tables_valid(const char *base, size_t len) {
+    const struct arg_image *header = (const struct arg_image *)base;
+    int n = header->count;
+    const char *pool = base + header->strings;
+    uint64_t size = len - header->strings;
+    const arg_t *args = (const arg_t *)(base + header->args);
+    const arg_key_t *keys = (const arg_key_t *)(base + header->keys);
+    bool dashless = false;
+    bool lists = false;
+    bool env = false;
+    for (int i = 0; i < n; i++) {
+        const arg_t *arg = &args[i];
+        const arg_key_t *key = &keys[i];
+        if ((unsigned int)arg->type > ARG_TYPE_LIST || key->type != (uint8_t)arg->type || key->short_name != arg->short_name ||
+            key->long_name != arg->long_name ||
+            !arg_image_string_valid(pool, size, key->short_name, key->short_len, true) ||
+            !arg_image_string_valid(pool, size, key->long_name, key->long_len, true) ||
+            !arg_image_string_valid(pool, size, arg->description, 0, false) ||
+            !arg_image_string_valid(pool, size, arg->env, 0, false)) {
+            return false;
+        }
+        dashless = dashless || (key->short_name && pool[(uintptr_t)key->short_name] != '-') ||
+                   (key->long_name && pool[(uintptr_t)key->long_name] != '-');
+        lists = lists || arg->type == ARG_TYPE_LIST;
+        env = env || arg->env;
+    }
+    /* The flags steer parsing, so they must agree with the table. */
+    if (dashless != ((header->flags & ARG_IMAGE_DASHLESS) != 0) || lists != ((header->flags & ARG_IMAGE_LISTS) != 0) ||
+        env != ((header->flags & ARG_IMAGE_ENV) != 0)) {
+        return false;
+    }
+    const uint64_t *required = (const uint64_t *)(base + header->required);
+    if (n % 64 && required[n / 64] >> (n % 64)) {
+        return false;
+    }
+    const int *index = (const int *)(base + header->index);
+    bool empty = false;
+    for (int pos = 0; pos < header->index_size; pos++) {
+        int slot = index[pos];
+        if (slot == ARG_INDEX_EMPTY) {
+            empty = true;
+        } else if (slot < 0 || slot >= 2 * n || !((slot & 1) ? keys[slot >> 1].long_name : keys[slot >> 1].short_name)) {
+            return false;
+        }
+    }
+    if (header->index_size && !empty) {
+        return false;
+    }
+    const int *sorted = (const int *)(base + header->sorted);
+    for (int k = 0; k < header->sorted_count; k++) {
+        if (sorted[k] < 0 || sorted[k] >= n || !keys[sorted[k]].long_name) {
+            return false;
+        }
+    }
+    return true;
+}
+
+arg_parser_t* arg_parser_load_compiled(const char *path) {
+    arg_parser_t *parser = arg_parser_create();
+    struct arg_response *image = parser ? (struct arg_response *)arg_arena_alloc(&parser->arena, sizeof(struct arg_response)) : NULL;
+    size_t len = 0;
+    if (!image || !arg_image_load(&parser->arena, path, image, &len)) {
+        arg_parser_free(parser);
+        return NULL;
+    }
+    parser->image = image;
+    const char *base = image->data;
+    const struct arg_image *header = (const struct arg_image *)base;
+    int n = arg_image_valid(header, len) && arg_image_tables_valid(base, len) ? header->count : -1;
+    void *result = n >= 0 ? arg_arena_alloc(&parser->arena, ARG_RESULT_SIZE(n)) : NULL;
+    if (!result) {
+        arg_parser_free(parser);
+        return NULL;
+    }
+    /* The library only reads the tables of a frozen schema, so the casts never lead to a write. */
+    arg_schema_t *schema = &parser->schema;
+    schema->args = (const arg_t *)(base + header->args);
+    schema->keys = (arg_key_t *)(uintptr_t)(base + header->keys);
+    schema->required = (uint64_t *)(uintptr_t)(base + header->required);
+    schema->count = n;
+    schema->index = header->index_size ? (int *)(uintptr_t)(base + header->index) : NULL;
+    schema->index_size = header->index_size;
+    schema->sorted = (int *)(uintptr_t)(base + header->sorted);
+    schema->sorted_count = header->sorted_count;
+    schema->sorted_for = n;
+    schema->dashless = (header->flags & ARG_IMAGE_DASHLESS) != 0;
+    schema->lists = (header->flags & ARG_IMAGE_LISTS) != 0;
+    schema->strings = base + header->strings;
+    parser->fallbacks = (header->flags & ARG_IMAGE_ENV) != 0;
+    arg_result_init(&parser->result, schema, result);
+    parser->result.arena = &parser->arena;
+    parser->capacity = n;
+    parser->frozen = true;
+    return parser;
+}
+
+/* Header of the compiled schema the parser was loaded from, or NULL. */
+static const struct arg_image* arg_parser_image(const arg_parser_t *parser) {
+    return parser->image ? (const struct arg_image *)parser->image->data : NULL;
+}
+
+static void arg_parser_help(arg_parser_t *parser, arg_text_t *text) {
+    ARG_TIMER(start);
+    const struct arg_image *image = arg_parser_image(parser);
+    if (image) {
+        arg_text_append(text, (const char *)image + image->help, image->help_len);
+    } else {
+        arg_help_render(&parser->schema, parser->commands, text);
+    }
+    ARG_TIMER_ADD(&parser->stats, help_ns, start);
+}
+
+size_t arg_parser_format_help(arg_parser_t *parser, char *buf, size_t size) {
+    arg_text_t text;
+    arg_text_init(&text, buf, size, true);
+    arg_parser_help(parser, &text);
+    return text.len;
+}
+
+void arg_parser_print_help(arg_parser_t *parser) {
+    char storage[4096];
+    arg_text_t text;
+    arg_text_init(&text, storage, sizeof(storage), false);
+    arg_parser_help(parser, &text);
+    arg_output(&parser->schema, ARG_OUTPUT_HELP, &text);
+    arg_text_free(&text);
+}
+
+void arg_parser_set_output(arg_parser_t *parser, arg_output_fn output, void *ctx) {
+    parser->schema.output = output;
+    parser->schema.output_ctx = ctx;
+}
+
+void arg_parser_free(arg_parser_t *parser) {
+    if (!parser) {
+        return;
+    }
+    arg_response_unmap(parser->responses);
+    arg_response_unmap(parser->image);
+    if (parser->fallback) {
+        arg_response_unmap(parser->fallback->config);
+    }
+    for (int k = 0; parser->commands && k < parser->commands->count; k++) {
+        arg_parser_free(parser->commands->list[k].child);
+    }
+    if (parser->is_static || ARG_PARSER_EMBEDDED(parser)) {
+        arg_arena_release(&parser->arena);
+        parser->responses = NULL;
+        parser->spare_responses = NULL;
+        parser->tokens = NULL;
+        parser->token_capacity = 0;
+        parser->result.items = NULL;
+        parser->result.item_ids = NULL;
+        parser->result.item_count = 0;
+        parser->result.item_capacity = 0;
+        parser->fallback = NULL;
+        parser->commands = NULL;
+        parser->wargv = NULL;
+        parser->wide = NULL;
+        parser->stream = NULL;
+    } else {
+        /* The parser lives in the arena; copy the arena out before releasing it. */
+        arg_arena_t arena = parser->arena;
+        arg_arena_release(&arena);
+    }
+}
+
+void arg_parser_reset(arg_parser_t *parser) {
+    /* The result is laid out for `capacity` arguments. */
+    if (parser->capacity) {
+        arg_result_clear(&parser->result, parser->capacity);
+    }
+    arg_parser_drop_responses(parser);
+    parser->wargv = NULL;
+    if (parser->stream) {
+        parser->stream->open = false;
+    }
+    for (int k = 0; parser->commands && k < parser->commands->count; k++) {
+        if (parser->commands->list[k].child) {
+            arg_parser_reset(parser->commands->list[k].child);
+        }
+    }
+    if (parser->commands) {
+        parser->commands->active = -1;
+    }
+}
+
+const arg_schema_t* arg_parser_freeze(arg_parser_t *parser) {
+    parser->frozen = true;
+    if (parser->schema.sorted && parser->schema.sorted_for != parser->schema.count) {
+        arg_sorted_build(&parser->schema);
+    }
+    return &parser->schema;
+}
+
+/* A heap result and the arena its list values are drawn from. */
+struct arg_result_box {
+    arg_result_t result;
+    arg_arena_t arena;
+};
+
+arg_result_t* arg_result_create(const arg_schema_t *schema) {
+    struct arg_result_box *box = (struct arg_result_box *)malloc(sizeof(struct arg_result_box));
+    if (!box) {
+        return NULL;
+    }
+    void *buf = malloc(ARG_RESULT_SIZE(schema->count));
+    if (!buf) {
+        free(box);
+        return NULL;
+    }
+    memset(&box->arena, 0, sizeof(arg_arena_t));
+    arg_result_init(&box->result, schema, buf);
+    box->result.arena = &box->arena;
+    return &box->result;
+}
+
+void arg_result_init(arg_result_t *result, const arg_schema_t *schema, void *buf) {
+    result->typed = (arg_value_t *)buf;
+    result->set = (uint64_t *)(result->typed + schema->count);
+    result->values = (arg_ref_t *)(result->set + ARG_BITSET_WORDS(schema->count));
+    result->items = NULL;
+    result->item_ids = NULL;
+    result->item_capacity = 0;
+    result->arena = NULL;
+#ifdef TINYARGS_STATS
+    result->stats = NULL;
+    result->on_match = NULL;
+    result->match_ctx = NULL;
+#endif
+    arg_result_clear(result, schema->count);
+}
+
+const char* arg_result_get_value(const arg_schema_t *schema, const arg_result_t *result, const char *name) {
+    int i = arg_index_find(schema, name);
+    return i < 0 ? NULL : arg_result_value_at(result, i);
+}
+
+bool arg_result_is_set(const arg_schema_t *schema, const arg_result_t *result, const char *name) {
+    int i = arg_index_find(schema, name);
+    return i < 0 ? false : arg_bit_test(result->set, i);
+}
+
+const char* arg_result_get_value_id(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id) {
+    if (id < 0 || id >= schema->count) {
+        return NULL;
+    }
+    return arg_result_value_at(result, id);
+}
+
+bool arg_result_is_set_id(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id) {
+    if (id < 0 || id >= schema->count) {
+        return false;
+    }
+    return arg_bit_test(result->set, id);
+}
+
+const arg_value_t* arg_result_get_typed_id(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id) {
+    if (id < 0 || id >= schema->count || schema->keys[id].type <= ARG_TYPE_VALUE ||
+        schema->keys[id].type == ARG_TYPE_LIST || !arg_result_has_value(result, id)) {
+        return NULL;
+    }
+    return &result->typed[id];
+}
+
+arg_view_t arg_result_get_view_id(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id) {
+    arg_view_t view = { NULL, 0 };
+    view.data = arg_result_get_value_id(schema, result, id);
+    view.len = view.data ? strlen(view.data) : 0;
+    return view;
+}
+
+const arg_ref_t* arg_result_get_values(const arg_schema_t *schema, const arg_result_t *result, arg_id_t id, int *count) {
+    *count = 0;
+    if (id < 0 || id >= schema->count || schema->keys[id].type != ARG_TYPE_LIST) {
+        return NULL;
+    }
+    int first = result->typed[id].list.first;
+    int n = result->typed[id].list.count;
+    if (n <= 0 || first < 0 || first + n > result->item_count) {
+        return NULL;
+    }
+    *count = n;
+    return &result->items[first];
+}
+
+size_t arg_result_format_error(const arg_schema_t *schema, const arg_result_t *result, char *buf, size_t size) {
+    arg_text_t text;
+    arg_text_init(&text, buf, size, true);
+    arg_error_render(schema, result, &text);
+    return text.len;
+}
+
+void arg_result_reset(const arg_schema_t *schema, arg_result_t *result) {
+    arg_result_clear(result, schema->count);
+}
+
+arg_span_t arg_result_get_positionals(const arg_result_t *result) {
+    arg_span_t span = { result->argv, result->positional_first, result->positional_count };
+    return span;
+}
+
+void arg_result_free(arg_result_t *result) {
+    if (result) {
+        /* `result` is the first member of its box. */
+        struct arg_result_box *box = (struct arg_result_box *)(void *)result;
+        arg_arena_release(&box->arena);
+        free(result->typed);
+        free(box);
     }
 }
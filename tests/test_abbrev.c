@@ -0,0 +1,105 @@
+/**
+ * @file test_abbrev.c
+ * @brief Long-name abbreviations: unique prefixes, ambiguity and suggestions.
+ */
+
+#include "tinyargs_test.h"
+
+static arg_parser_t* abbrev_cli(test_output_t *out) {
+    arg_parser_t *parser = arg_parser_create();
+    arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose");
+    arg_parser_add(parser, NULL, "--version", ARG_TYPE_FLAG, false, "Version");
+    arg_parser_add(parser, "-i", "--in", ARG_TYPE_VALUE, false, "Input");
+    arg_parser_add(parser, NULL, "--include", ARG_TYPE_LIST, false, "Include");
+    arg_parser_add(parser, "-o", "--output", ARG_TYPE_VALUE, false, "Output");
+    test_capture_to(parser, out);
+    return parser;
+}
+
+static void test_unique_prefix(void) {
+    test_output_t out;
+    arg_parser_t *parser = abbrev_cli(&out);
+    char *argv[] = { "prog", "--verb", "--vers", "--out=a.txt", "--inc", "x" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_is_flag_set(parser, "--verbose"));
+    CHECK(arg_parser_is_flag_set(parser, "--version"));
+    CHECK_STR(arg_parser_get_value(parser, "--output"), "a.txt");
+    int count = 0;
+    const arg_ref_t *items = arg_parser_get_values(parser, arg_parser_find(parser, "--include"), &count);
+    CHECK(count == 1);
+    if (items && count == 1) {
+        CHECK_STR(argv[items[0].index] + items[0].offset, "x");
+    }
+    CHECK(out.len == 0);
+    arg_parser_free(parser);
+}
+
+/* A full name wins over the longer names it is a prefix of. */
+static void test_exact_match(void) {
+    test_output_t out;
+    arg_parser_t *parser = abbrev_cli(&out);
+    char *argv[] = { "prog", "--in", "a", "--in=b" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK_STR(arg_parser_get_value(parser, "-i"), "b");
+    CHECK(!arg_parser_is_flag_set(parser, "--include"));
+    arg_parser_free(parser);
+}
+
+static void test_ambiguous(void) {
+    test_output_t out;
+    arg_parser_t *parser = abbrev_cli(&out);
+    char *argv[] = { "prog", "-v", "--ver" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    const arg_error_t *error = arg_parser_get_error(parser);
+    CHECK(error->code == ARG_ERROR_AMBIGUOUS);
+    CHECK(error->index == 2);
+    CHECK(out.kind == ARG_OUTPUT_ERROR);
+    CHECK_STR(out.text, "Error: Ambiguous argument --ver (could be --verbose, --version)\n");
+    arg_parser_free(parser);
+
+    /* The `=value` part is not part of the name being matched. */
+    parser = abbrev_cli(&out);
+    char *attached[] = { "prog", "--v=1" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(attached), attached));
+    CHECK(arg_parser_get_error(parser)->code == ARG_ERROR_AMBIGUOUS);
+    CHECK_STR(out.text, "Error: Ambiguous argument --v (could be --verbose, --version)\n");
+    arg_parser_free(parser);
+}
+
+static void test_suggestion(void) {
+    test_output_t out;
+    arg_parser_t *parser = abbrev_cli(&out);
+    char *argv[] = { "prog", "--verbsoe" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_get_error(parser)->code == ARG_ERROR_UNRECOGNIZED);
+    CHECK_STR(out.text, "Error: Unrecognized argument --verbsoe (did you mean --verbose?)\n");
+    arg_parser_free(parser);
+
+    parser = abbrev_cli(&out);
+    char *typo[] = { "prog", "--outptu=x" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(typo), typo));
+    CHECK_STR(out.text, "Error: Unrecognized argument --outptu=x (did you mean --output?)\n");
+    arg_parser_free(parser);
+
+    /* Nothing close enough: no suggestion. */
+    parser = abbrev_cli(&out);
+    char *far[] = { "prog", "--zzz" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(far), far));
+    CHECK_STR(out.text, "Error: Unrecognized argument --zzz\n");
+    arg_parser_free(parser);
+
+    /* Short names are never abbreviated or suggested. */
+    parser = abbrev_cli(&out);
+    char *shorts[] = { "prog", "-x" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(shorts), shorts));
+    CHECK_STR(out.text, "Error: Unrecognized argument -x\n");
+    arg_parser_free(parser);
+}
+
+int main(void) {
+    test_unique_prefix();
+    test_exact_match();
+    test_ambiguous();
+    test_suggestion();
+    TEST_DONE();
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_commands.c
+ * @brief Subcommands: lazy construction, dispatch and their errors.
+ */
+
+#include "tinyargs_test.h"
+
+typedef struct {
+    int builds;
+    int fail;
+} command_ctx_t;
+
+static int build_build(arg_parser_t *parser, void *ctx) {
+    command_ctx_t *state = (command_ctx_t *)ctx;
+    state->builds++;
+    arg_parser_add(parser, "-r", "--release", ARG_TYPE_FLAG, false, "Release build");
+    arg_parser_add(parser, "-j", "--jobs", ARG_TYPE_INT, false, "Jobs");
+    return !state->fail;
+}
+
+static int build_test(arg_parser_t *parser, void *ctx) {
+    command_ctx_t *state = (command_ctx_t *)ctx;
+    state->builds++;
+    arg_parser_add(parser, "-f", "--filter", ARG_TYPE_VALUE, true, "Filter");
+    return !state->fail;
+}
+
+typedef struct {
+    arg_parser_t *parser;
+    command_ctx_t build;
+    command_ctx_t test;
+    test_output_t out;
+} command_cli_t;
+
+static void command_cli_init(command_cli_t *cli) {
+    memset(cli, 0, sizeof(*cli));
+    cli->parser = arg_parser_create();
+    arg_parser_add(cli->parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose");
+    CHECK(arg_parser_add_command(cli->parser, "build", build_build, &cli->build, "Build the project"));
+    CHECK(arg_parser_add_command(cli->parser, "test", build_test, &cli->test, "Run the tests"));
+    CHECK(!arg_parser_add_command(cli->parser, "build", build_build, &cli->build, NULL));
+    test_capture_to(cli->parser, &cli->out);
+}
+
+/* Only the selected subcommand is built, once, however often it is dispatched to. */
+static void test_lazy(void) {
+    command_cli_t cli;
+    command_cli_init(&cli);
+    char *argv[] = { "prog", "-v", "build", "-r", "--jobs", "4", "extra" };
+    for (int pass = 0; pass < 3; pass++) {
+        CHECK(arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    }
+    CHECK(cli.build.builds == 1);
+    CHECK(cli.test.builds == 0);
+    CHECK_STR(arg_parser_get_command(cli.parser), "build");
+    CHECK(arg_parser_is_flag_set(cli.parser, "-v"));
+    arg_parser_t *child = arg_parser_get_command_parser(cli.parser);
+    CHECK(child != NULL);
+    if (child) {
+        CHECK(arg_parser_is_flag_set(child, "--release"));
+        CHECK(arg_parser_get_int(child, "-j", 0) == 4);
+        /* Options after the subcommand name are the child's, not the parent's. */
+        CHECK(arg_parser_find(child, "-v") < 0);
+        arg_span_t span = arg_parser_get_positionals(child);
+        CHECK(span.count == 1);
+        if (span.count == 1) {
+            CHECK_STR(span.argv[span.first], "extra");
+        }
+    }
+
+    /* A vector without positionals selects nothing. */
+    char *bare[] = { "prog", "-v" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(bare), bare));
+    CHECK(arg_parser_get_command(cli.parser) == NULL);
+    CHECK(arg_parser_get_command_parser(cli.parser) == NULL);
+    CHECK(cli.test.builds == 0);
+
+    char *other[] = { "prog", "test", "-f", "unit" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(other), other));
+    CHECK(cli.test.builds == 1);
+    CHECK_STR(arg_parser_get_command(cli.parser), "test");
+    CHECK(cli.out.len == 0);
+    arg_parser_free(cli.parser);
+}
+
+static void test_errors(void) {
+    command_cli_t cli;
+    command_cli_init(&cli);
+    char *unknown[] = { "prog", "-v", "deploy" };
+    CHECK(!arg_parser_parse(cli.parser, TEST_ARGC(unknown), unknown));
+    const arg_error_t *error = arg_parser_get_error(cli.parser);
+    CHECK(error->code == ARG_ERROR_UNKNOWN_COMMAND);
+    CHECK(error->index == 2);
+    CHECK_STR(cli.out.text, "Error: Unknown command deploy\n");
+    CHECK(cli.build.builds == 0 && cli.test.builds == 0);
+
+    /* A failed construction is reported and retried on the next dispatch. */
+    cli.build.fail = 1;
+    test_capture_to(cli.parser, &cli.out);
+    char *argv[] = { "prog", "build" };
+    CHECK(!arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_COMMAND_FAILED);
+    CHECK(arg_parser_get_error(cli.parser)->index == 1);
+    CHECK_STR(cli.out.text, "Error: Could not set up command build\n");
+    CHECK(arg_parser_get_command_parser(cli.parser) == NULL);
+    cli.build.fail = 0;
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    CHECK(cli.build.builds == 2);
+
+    /* The child records and reports its own errors. */
+    test_capture_to(cli.parser, &cli.out);
+    char *missing[] = { "prog", "test" };
+    CHECK(!arg_parser_parse(cli.parser, TEST_ARGC(missing), missing));
+    CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_NONE);
+    arg_parser_t *child = arg_parser_get_command_parser(cli.parser);
+    CHECK(child != NULL);
+    if (child) {
+        CHECK(arg_parser_get_error(child)->code == ARG_ERROR_MISSING_REQUIRED);
+    }
+    CHECK(cli.out.writes == 1);
+    CHECK_STR(cli.out.text, "Error: Missing required argument --filter\n");
+    arg_parser_free(cli.parser);
+}
+
+static void test_help(void) {
+    command_cli_t cli;
+    command_cli_init(&cli);
+    char buf[512];
+    arg_parser_format_help(cli.parser, buf, sizeof(buf));
+    CHECK(strstr(buf, "Commands:\n  build  Build the project\n  test   Run the tests\n") != NULL);
+    /* Listing the subcommands does not construct them. */
+    CHECK(cli.build.builds == 0 && cli.test.builds == 0);
+    arg_parser_free(cli.parser);
+}
+
+int main(void) {
+    test_lazy();
+    test_errors();
+    test_help();
+    TEST_DONE();
+}
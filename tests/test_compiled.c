@@ -0,0 +1,165 @@
+/**
+ * @file test_compiled.c
+ * @brief Compiled schemas: round trip through a file, and rejection of damaged files.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "tinyargs_test.h"
+#include <stdlib.h>
+
+static arg_parser_t* compiled_cli(void) {
+    arg_parser_t *parser = arg_parser_create();
+    arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose output");
+    arg_id_t jobs = arg_parser_add(parser, "-j", "--jobs", ARG_TYPE_INT, false, "Parallel jobs");
+    arg_parser_add(parser, "-n", "--name", ARG_TYPE_VALUE, true, "Name to greet");
+    arg_parser_add(parser, "-I", "--include", ARG_TYPE_LIST, false, "Include directory");
+    arg_parser_add(parser, NULL, "--version", ARG_TYPE_FLAG, false, NULL);
+    arg_parser_bind_env(parser, jobs, "TEST_COMPILED_JOBS");
+    return parser;
+}
+
+static char* read_file(const char *path, size_t *len) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    char *data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        data = size > 0 ? (char *)malloc((size_t)size) : NULL;
+        rewind(file);
+        if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+            free(data);
+            data = NULL;
+        }
+        *len = (size_t)size;
+    }
+    fclose(file);
+    return data;
+}
+
+static void write_file(const char *path, const char *data, size_t len) {
+    FILE *file = fopen(path, "wb");
+    CHECK(file != NULL);
+    if (file) {
+        CHECK(fwrite(data, 1, len, file) == len);
+        fclose(file);
+    }
+}
+
+/* Exercises every part of a loaded schema that parsing and error messages read. */
+static void exercise(arg_parser_t *parser) {
+    test_output_t out;
+    test_capture_to(parser, &out);
+    char *good[] = { "prog", "--verb", "-j", "3", "--name=x", "-Ia", "-I", "b", "--ver", "--vers", "pos" };
+    char *bad[] = { "prog", "--verbsoe", "-q", "--nam" };
+    arg_parser_parse(parser, TEST_ARGC(good), good);
+    arg_parser_parse(parser, TEST_ARGC(bad), bad);
+    for (int k = 1; k < TEST_ARGC(bad); k++) {
+        char *one[] = { "prog", bad[k] };
+        arg_parser_parse(parser, 2, one);
+    }
+    arg_parser_format_help(parser, out.text, sizeof(out.text));
+    arg_parser_get_int(parser, "--jobs", 0);
+}
+
+static void test_round_trip(const char *path) {
+    arg_parser_t *source = compiled_cli();
+    char expected_help[1024];
+    arg_parser_format_help(source, expected_help, sizeof(expected_help));
+    CHECK(arg_parser_compile_to(source, path));
+    arg_parser_free(source);
+
+    arg_parser_t *parser = arg_parser_load_compiled(path);
+    CHECK(parser != NULL);
+    if (!parser) {
+        return;
+    }
+    char help[1024];
+    arg_parser_format_help(parser, help, sizeof(help));
+    CHECK_STR(help, expected_help);
+    char *argv[] = { "prog", "--verb", "-n", "x", "-Ia", "--include=b", "pos" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_is_flag_set(parser, "--verbose"));
+    CHECK_STR(arg_parser_get_value(parser, "--name"), "x");
+    int count = 0;
+    arg_parser_get_values(parser, arg_parser_find(parser, "-I"), &count);
+    CHECK(count == 2);
+    CHECK(arg_parser_get_positionals(parser).count == 1);
+
+    /* Names stay offsets into the file; the accessor resolves them. */
+    const arg_schema_t *schema = arg_parser_freeze(parser);
+    CHECK(schema->strings != NULL);
+    CHECK_STR(arg_schema_string(schema, schema->keys[1].long_name), "--jobs");
+    CHECK_STR(arg_schema_string(schema, schema->args[2].description), "Name to greet");
+    CHECK(arg_schema_string(schema, schema->keys[4].short_name) == NULL);
+
+    /* Environment bindings are compiled in, and the table cannot be rebound. */
+    setenv("TEST_COMPILED_JOBS", "6", 1);
+    CHECK(arg_parser_get_int(parser, "-j", 0) == 6);
+    unsetenv("TEST_COMPILED_JOBS");
+    CHECK(!arg_parser_bind_env(parser, 0, "TEST_COMPILED_VERBOSE"));
+
+    test_output_t out;
+    test_capture_to(parser, &out);
+    char *typo[] = { "prog", "--ver", "-n", "x" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(typo), typo));
+    CHECK_STR(out.text, "Error: Ambiguous argument --ver (could be --verbose, --version)\n");
+    test_capture_to(parser, &out);
+    char *missing[] = { "prog", "--verbsoe" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(missing), missing));
+    CHECK_STR(out.text, "Error: Unrecognized argument --verbsoe (did you mean --verbose?)\n");
+    arg_parser_free(parser);
+}
+
+/*
+ * Every single-byte change to the file is either rejected or yields a schema
+ * that parses within bounds; run under AddressSanitizer, this catches any
+ * table entry the loader forgets to check. Truncated files are rejected.
+ */
+static void test_damaged(const char *path) {
+    size_t len = 0;
+    char *blob = read_file(path, &len);
+    CHECK(blob != NULL);
+    if (!blob) {
+        return;
+    }
+    char *copy = (char *)malloc(len);
+    int rejected = 0;
+    for (size_t pos = 0; pos < len; pos++) {
+        static const unsigned char masks[] = { 0xff, 0x80, 0x01 };
+        for (size_t m = 0; m < sizeof(masks); m++) {
+            memcpy(copy, blob, len);
+            copy[pos] = (char)(copy[pos] ^ masks[m]);
+            write_file(path, copy, len);
+            arg_parser_t *parser = arg_parser_load_compiled(path);
+            if (!parser) {
+                rejected++;
+                continue;
+            }
+            exercise(parser);
+            arg_parser_free(parser);
+        }
+    }
+    /* The header and every name offset are covered, so plenty of changes must be caught. */
+    CHECK(rejected > (int)len / 4);
+    for (size_t cut = 0; cut < len; cut += 7) {
+        write_file(path, blob, cut);
+        arg_parser_t *parser = arg_parser_load_compiled(path);
+        CHECK(parser == NULL);
+        arg_parser_free(parser);
+    }
+    free(copy);
+    free(blob);
+}
+
+int main(void) {
+    const char *path = "test_compiled.schema";
+    test_round_trip(path);
+    test_damaged(path);
+    remove(path);
+    TEST_DONE();
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_errors.c
+ * @brief Structured parse errors: code, token index, value offset, argument id and message.
+ */
+
+#include "tinyargs_test.h"
+#include <stdlib.h>
+
+typedef struct {
+    arg_parser_t *parser;
+    arg_id_t verbose;
+    arg_id_t jobs;
+    arg_id_t name;
+    arg_id_t include;
+} error_cli_t;
+
+static void error_cli_init(error_cli_t *cli, arg_parser_t *parser) {
+    cli->parser = parser;
+    cli->verbose = arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose");
+    cli->jobs = arg_parser_add(parser, "-j", "--jobs", ARG_TYPE_INT, false, "Jobs");
+    cli->name = arg_parser_add(parser, "-n", "--name", ARG_TYPE_VALUE, true, "Name");
+    cli->include = arg_parser_add(parser, "-I", "--include", ARG_TYPE_LIST, false, "Include");
+}
+
+typedef struct {
+    const char *argv[4];
+    arg_error_code_t code;
+    int index;
+    int offset;
+    int which;                  /* 0: no argument, 1: verbose, 2: jobs, 3: name */
+    const char *message;
+} error_case_t;
+
+static const error_case_t error_cases[] = {
+    { { "-x" }, ARG_ERROR_UNRECOGNIZED, 1, 0, 0, "Error: Unrecognized argument -x\n" },
+    { { "-na", "-vx" }, ARG_ERROR_UNRECOGNIZED, 2, 0, 0, "Error: Unrecognized argument -vx\n" },
+    { { "--verbose=1", "-na" }, ARG_ERROR_UNEXPECTED_VALUE, 1, 10, 1,
+      "Error: Argument --verbose does not take a value\n" },
+    { { "-v", "-n" }, ARG_ERROR_MISSING_VALUE, 2, 0, 3, "Error: Missing value for argument -n\n" },
+    { { "--name" }, ARG_ERROR_MISSING_VALUE, 1, 0, 3, "Error: Missing value for argument --name\n" },
+    { { "-n", "a", "-vj5x" }, ARG_ERROR_INVALID_VALUE, 3, 3, 2, "Error: Invalid value for argument --jobs: 5x\n" },
+    { { "-na", "--jobs=abc" }, ARG_ERROR_INVALID_VALUE, 2, 7, 2,
+      "Error: Invalid value for argument --jobs: abc\n" },
+    { { "-v" }, ARG_ERROR_MISSING_REQUIRED, -1, 0, 3, "Error: Missing required argument --name\n" },
+};
+
+static void test_codes(void) {
+    for (size_t k = 0; k < sizeof(error_cases) / sizeof(error_cases[0]); k++) {
+        const error_case_t *c = &error_cases[k];
+        error_cli_t cli;
+        error_cli_init(&cli, arg_parser_create());
+        test_output_t out;
+        test_capture_to(cli.parser, &out);
+        char *argv[5] = { "prog" };
+        int argc = 1;
+        while (argc < 5 && c->argv[argc - 1]) {
+            argv[argc] = (char *)c->argv[argc - 1];
+            argc++;
+        }
+        arg_id_t ids[] = { -1, cli.verbose, cli.jobs, cli.name };
+        CHECK(!arg_parser_parse(cli.parser, argc, argv));
+        const arg_error_t *error = arg_parser_get_error(cli.parser);
+        if (error->code != c->code || error->index != c->index || error->offset != c->offset
+            || error->id != ids[c->which]) {
+            fprintf(stderr, "case %u (%s): got code %d, index %d, offset %d, id %d\n", (unsigned)k, c->argv[0],
+                    (int)error->code, error->index, error->offset, (int)error->id);
+            test_failures++;
+        }
+        CHECK_STR(out.text, c->message);
+        char buf[128];
+        CHECK(arg_parser_format_error(cli.parser, buf, sizeof(buf)) == strlen(c->message));
+        CHECK_STR(buf, c->message);
+        arg_parser_free(cli.parser);
+    }
+}
+
+/* A successful parse clears the previous error. */
+static void test_cleared(void) {
+    error_cli_t cli;
+    error_cli_init(&cli, arg_parser_create());
+    test_output_t out;
+    test_capture_to(cli.parser, &out);
+    char *bad[] = { "prog", "-x" };
+    CHECK(!arg_parser_parse(cli.parser, TEST_ARGC(bad), bad));
+    char *good[] = { "prog", "-n", "a" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(good), good));
+    const arg_error_t *error = arg_parser_get_error(cli.parser);
+    CHECK(error->code == ARG_ERROR_NONE);
+    CHECK(error->index == -1);
+    CHECK(error->id == -1);
+    CHECK(arg_parser_format_error(cli.parser, NULL, 0) == 0);
+    arg_parser_free(cli.parser);
+}
+
+static int alloc_budget;
+
+static void* limited_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    if (alloc_budget <= 0) {
+        return NULL;
+    }
+    alloc_budget--;
+    return malloc(size);
+}
+
+static void limited_free(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+/* Running out of list storage names the list and the token whose value could not be kept. */
+static void test_no_memory(void) {
+    static char *argv[2001];
+    argv[0] = "prog";
+    argv[1] = "-nx";
+    for (int i = 2; i < TEST_ARGC(argv); i++) {
+        argv[i] = "-Ia";
+    }
+    alloc_budget = 1000;
+    error_cli_t cli;
+    error_cli_init(&cli, arg_parser_create_with_allocator(limited_alloc, limited_free, NULL));
+    test_output_t out;
+    test_capture_to(cli.parser, &out);
+    alloc_budget = 0;
+    CHECK(!arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    const arg_error_t *error = arg_parser_get_error(cli.parser);
+    CHECK(error->code == ARG_ERROR_NO_MEMORY);
+    CHECK(error->index > 1 && error->index < TEST_ARGC(argv));
+    CHECK(error->offset == 2);
+    CHECK(error->id == cli.include);
+    CHECK_STR(out.text, "Error: Out of memory while storing a value for argument --include\n");
+    alloc_budget = 1000;
+    arg_parser_free(cli.parser);
+}
+
+int main(void) {
+    test_codes();
+    test_cleared();
+    test_no_memory();
+    TEST_DONE();
+}
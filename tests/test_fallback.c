@@ -0,0 +1,162 @@
+/**
+ * @file test_fallback.c
+ * @brief Environment and config-file fallbacks: precedence, flags and lazy lookup.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "tinyargs_test.h"
+#include <stdlib.h>
+
+static const char config_text[] =
+    "# comment\n"
+    "threads = 3\n"
+    "name = \"from config\"\n"
+    "; another comment\n"
+    "threads = 5\n"
+    "force = yes\n"
+    "include = ignored\n"
+    "\n"
+    "[server]\n"
+    "port = 8080\n";
+
+typedef struct {
+    arg_parser_t *parser;
+    arg_id_t force;
+    arg_id_t threads;
+    arg_id_t name;
+    arg_id_t port;
+    arg_id_t include;
+} fallback_cli_t;
+
+static void fallback_cli_init(fallback_cli_t *cli, bool force_required) {
+    cli->parser = arg_parser_create();
+    cli->force = arg_parser_add(cli->parser, "-f", "--force", ARG_TYPE_FLAG, force_required, "Force");
+    cli->threads = arg_parser_add(cli->parser, "-t", "--threads", ARG_TYPE_INT, false, "Threads");
+    cli->name = arg_parser_add(cli->parser, "-n", "--name", ARG_TYPE_VALUE, false, "Name");
+    cli->port = arg_parser_add(cli->parser, NULL, "--server.port", ARG_TYPE_INT, false, "Port");
+    cli->include = arg_parser_add(cli->parser, "-I", "--include", ARG_TYPE_LIST, false, "Include");
+    arg_parser_bind_env(cli->parser, cli->force, "TEST_FALLBACK_FORCE");
+    arg_parser_bind_env(cli->parser, cli->threads, "TEST_FALLBACK_THREADS");
+    arg_parser_bind_env(cli->parser, cli->name, "TEST_FALLBACK_NAME");
+}
+
+static void write_config(void) {
+    FILE *file = fopen("test_fallback.ini", "wb");
+    CHECK(file != NULL);
+    if (file) {
+        fputs(config_text, file);
+        fclose(file);
+    }
+}
+
+static void clear_env(void) {
+    unsetenv("TEST_FALLBACK_FORCE");
+    unsetenv("TEST_FALLBACK_THREADS");
+    unsetenv("TEST_FALLBACK_NAME");
+}
+
+/* Command line, then environment, then config file, then the accessor's fallback. */
+static void test_precedence(void) {
+    clear_env();
+    setenv("TEST_FALLBACK_THREADS", "7", 1);
+    fallback_cli_t cli;
+    fallback_cli_init(&cli, false);
+    CHECK(arg_parser_load_config(cli.parser, "test_fallback.ini"));
+    char *argv[] = { "prog", "--name", "cli" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    CHECK_STR(arg_parser_get_value(cli.parser, "--name"), "cli");
+    CHECK(arg_parser_get_int(cli.parser, "--threads", 0) == 7);
+    CHECK(arg_parser_get_int(cli.parser, "--server.port", 0) == 8080);
+    CHECK(arg_parser_is_flag_set(cli.parser, "--force"));
+    /* List arguments only take values from the command line. */
+    int count = 0;
+    CHECK(arg_parser_get_values(cli.parser, cli.include, &count) == NULL);
+    CHECK(count == 0);
+    arg_parser_free(cli.parser);
+
+    /* Without the variable, the last matching config line wins. */
+    clear_env();
+    fallback_cli_init(&cli, false);
+    CHECK(arg_parser_load_config(cli.parser, "test_fallback.ini"));
+    char *none[] = { "prog" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(none), none));
+    CHECK(arg_parser_get_int(cli.parser, "-t", 0) == 5);
+    CHECK_STR(arg_parser_get_value(cli.parser, "-n"), "from config");
+    const arg_value_t *threads = arg_parser_get_typed_id(cli.parser, cli.threads);
+    CHECK(threads && threads->i == 5);
+    arg_parser_free(cli.parser);
+
+    /* Without either, the accessor's fallback. */
+    fallback_cli_init(&cli, false);
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(none), none));
+    CHECK(arg_parser_get_int(cli.parser, "-t", 42) == 42);
+    CHECK(!arg_parser_is_flag_set(cli.parser, "-f"));
+    CHECK(!arg_parser_load_config(cli.parser, "test_fallback_missing.ini"));
+    arg_parser_free(cli.parser);
+
+    /* A typed value that does not convert is ignored, falling through to the config file. */
+    setenv("TEST_FALLBACK_THREADS", "many", 1);
+    fallback_cli_init(&cli, false);
+    CHECK(arg_parser_load_config(cli.parser, "test_fallback.ini"));
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(none), none));
+    CHECK(arg_parser_get_int(cli.parser, "-t", 0) == 5);
+    arg_parser_free(cli.parser);
+    clear_env();
+}
+
+/* A flag is set only by a truthy value, and only then does it satisfy `required`. */
+static void test_flags(void) {
+    static const struct { const char *text; bool set; } cases[] = {
+        { "1", true }, { "yes", true }, { "on", true }, { "anything", true },
+        { "0", false }, { "", false }, { "false", false }, { "no", false }, { "off", false }, { "OFF", false },
+    };
+    char *argv[] = { "prog" };
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+        clear_env();
+        setenv("TEST_FALLBACK_FORCE", cases[k].text, 1);
+        fallback_cli_t cli;
+        fallback_cli_init(&cli, true);
+        test_output_t out;
+        test_capture_to(cli.parser, &out);
+        int ok = arg_parser_parse(cli.parser, TEST_ARGC(argv), argv);
+        if (ok != (cases[k].set ? 1 : 0)) {
+            fprintf(stderr, "TEST_FALLBACK_FORCE=\"%s\": parse returned %d\n", cases[k].text, ok);
+            test_failures++;
+        }
+        CHECK(arg_parser_is_flag_set(cli.parser, "--force") == cases[k].set);
+        if (!cases[k].set) {
+            CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_MISSING_REQUIRED);
+            CHECK(arg_parser_get_error(cli.parser)->id == cli.force);
+            CHECK_STR(out.text, "Error: Missing required argument --force\n");
+        }
+        arg_parser_free(cli.parser);
+    }
+    clear_env();
+}
+
+/* Variables are read the first time an accessor needs them, and then kept. */
+static void test_lazy(void) {
+    clear_env();
+    fallback_cli_t cli;
+    fallback_cli_init(&cli, false);
+    char *argv[] = { "prog" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    setenv("TEST_FALLBACK_NAME", "late", 1);
+    CHECK_STR(arg_parser_get_value(cli.parser, "--name"), "late");
+    setenv("TEST_FALLBACK_NAME", "later", 1);
+    CHECK_STR(arg_parser_get_value(cli.parser, "--name"), "late");
+    arg_parser_free(cli.parser);
+    clear_env();
+}
+
+int main(void) {
+    write_config();
+    test_precedence();
+    test_flags();
+    test_lazy();
+    remove("test_fallback.ini");
+    TEST_DONE();
+}
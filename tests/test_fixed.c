@@ -0,0 +1,77 @@
+/**
+ * @file test_fixed.c
+ * @brief Fixed capacity: parsers built with a small `TINYARGS_MAX_ARGS`.
+ *
+ * Compiled together with its own copy of the library, with `TINYARGS_MAX_ARGS`
+ * below the growth step that heap-backed parsers start from.
+ */
+
+#include "tinyargs_test.h"
+
+#if !defined(TINYARGS_MAX_ARGS) || TINYARGS_MAX_ARGS != 4
+#error "test_fixed expects TINYARGS_MAX_ARGS=4"
+#endif
+
+/* Fills the parser to capacity; the next argument does not fit. */
+static void add_four(arg_parser_t *parser) {
+    CHECK(arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose") == 0);
+    CHECK(arg_parser_add(parser, "-j", "--jobs", ARG_TYPE_INT, false, "Jobs") == 1);
+    CHECK(arg_parser_add(parser, "-n", "--name", ARG_TYPE_VALUE, true, "Name") == 2);
+    CHECK(arg_parser_add(parser, "-I", "--include", ARG_TYPE_LIST, false, "Include") == 3);
+    CHECK(arg_parser_add(parser, "-q", "--quiet", ARG_TYPE_FLAG, false, "Quiet") == -1);
+    CHECK(!arg_parser_reserve(parser, TINYARGS_MAX_ARGS + 1));
+}
+
+static void check_parse(arg_parser_t *parser) {
+    char *argv[] = { "prog", "--verb", "-j", "3", "--name=x", "-Ia", "--include", "b", "pos" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_is_flag_set(parser, "-v"));
+    CHECK(arg_parser_get_int(parser, "--jobs", 0) == 3);
+    CHECK_STR(arg_parser_get_value(parser, "-n"), "x");
+    int count = 0;
+    arg_parser_get_values(parser, 3, &count);
+    CHECK(count == 2);
+    CHECK(arg_parser_get_positionals(parser).count == 1);
+
+    test_output_t out;
+    test_capture_to(parser, &out);
+    char *bad[] = { "prog", "--quiet", "-n", "x" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(bad), bad));
+    CHECK_STR(out.text, "Error: Unrecognized argument --quiet\n");
+}
+
+/* A heap parser binds its inline storage on the first add, however small it is. */
+static void test_create(void) {
+    arg_parser_t *parser = arg_parser_create();
+    CHECK(parser != NULL);
+    if (!parser) {
+        return;
+    }
+    add_four(parser);
+    check_parse(parser);
+    arg_parser_free(parser);
+
+    parser = arg_parser_create();
+    CHECK(arg_parser_reserve(parser, TINYARGS_MAX_ARGS));
+    add_four(parser);
+    arg_parser_free(parser);
+}
+
+static void test_init(void) {
+    arg_parser_t parser;
+    CHECK(arg_parser_init(&parser));
+    add_four(&parser);
+    check_parse(&parser);
+    arg_parser_reset(&parser);
+    char *argv[] = { "prog", "-n", "y" };
+    CHECK(arg_parser_parse(&parser, TEST_ARGC(argv), argv));
+    CHECK(!arg_parser_is_flag_set(&parser, "-v"));
+    CHECK_STR(arg_parser_get_value(&parser, "--name"), "y");
+    arg_parser_free(&parser);
+}
+
+int main(void) {
+    test_create();
+    test_init();
+    TEST_DONE();
+}
@@ -0,0 +1,88 @@
+/**
+ * @file test_gen.c
+ * @brief Parsers emitted by tinyargs_gen from tests/gen_demo.schema and tests/gen_empty.schema.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "tinyargs_test.h"
+#include "gen_demo_args.h"
+#include "gen_empty_args.h"
+#include <stdlib.h>
+
+/* Every field comes from the typed result of its own argument. */
+static void test_fields(void) {
+    unsetenv("GEN_DEMO_JOBS");
+    gen_demo_args_t args;
+    CHECK(gen_demo_init(&args));
+    char *argv[] = { "prog", "--verb", "-n", "x", "-j", "3", "--ratio=0.5", "--limit", "4K",
+                     "-t", "250ms", "-Ia", "--include=b", "pos" };
+    CHECK(gen_demo_parse(&args, TEST_ARGC(argv), argv));
+    CHECK(args.verbose);
+    CHECK_STR(args.name, "x");
+    CHECK(args.has_jobs && args.jobs == 3);
+    CHECK(args.has_ratio && args.ratio == 0.5);
+    CHECK(args.has_limit && args.limit == 4096);
+    CHECK(args.has_timeout && args.timeout == 250000000);
+    CHECK(args.include_count == 2);
+    if (args.include_count == 2) {
+        CHECK_STR(argv[args.include[1].index] + args.include[1].offset, "b");
+    }
+    /* Both names of the last argument belong to --jobs, so it is never set. */
+    CHECK(!args.has_jobs_7 && args.jobs_7 == 0);
+    CHECK(args.positionals.count == 1);
+    CHECK(arg_parser_get_int(&args.parser, "--jobs", 0) == 3);
+
+    /* Unset typed fields are 0 with their `has_` field clear; fallbacks still apply. */
+    setenv("GEN_DEMO_JOBS", "6", 1);
+    arg_parser_reset(&args.parser);
+    char *bare[] = { "prog", "--name", "y" };
+    CHECK(gen_demo_parse(&args, TEST_ARGC(bare), bare));
+    CHECK(!args.verbose);
+    CHECK(args.has_jobs && args.jobs == 6);
+    CHECK(!args.has_ratio && args.ratio == 0);
+    CHECK(!args.has_limit && args.limit == 0);
+    CHECK(!args.has_timeout && args.timeout == 0);
+    CHECK(args.include_count == 0);
+    unsetenv("GEN_DEMO_JOBS");
+    gen_demo_free(&args);
+}
+
+static void test_errors(void) {
+    gen_demo_args_t args;
+    CHECK(gen_demo_init(&args));
+    test_output_t out;
+    test_capture_to(&args.parser, &out);
+    char *missing[] = { "prog", "-v" };
+    CHECK(!gen_demo_parse(&args, TEST_ARGC(missing), missing));
+    CHECK_STR(out.text, "Error: Missing required argument --name\n");
+    test_capture_to(&args.parser, &out);
+    char *typo[] = { "prog", "-n", "x", "--verbsoe" };
+    CHECK(!gen_demo_parse(&args, TEST_ARGC(typo), typo));
+    CHECK_STR(out.text, "Error: Unrecognized argument --verbsoe (did you mean --verbose?)\n");
+    gen_demo_free(&args);
+}
+
+/* A schema without arguments only collects positionals. */
+static void test_empty(void) {
+    gen_empty_args_t args;
+    CHECK(gen_empty_init(&args));
+    test_output_t out;
+    test_capture_to(&args.parser, &out);
+    char *argv[] = { "prog", "one", "two" };
+    CHECK(gen_empty_parse(&args, TEST_ARGC(argv), argv));
+    CHECK(args.positionals.count == 2);
+    char *bad[] = { "prog", "--any" };
+    CHECK(!gen_empty_parse(&args, TEST_ARGC(bad), bad));
+    CHECK(arg_parser_get_error(&args.parser)->code == ARG_ERROR_UNRECOGNIZED);
+    gen_empty_free(&args);
+}
+
+int main(void) {
+    test_fields();
+    test_errors();
+    test_empty();
+    TEST_DONE();
+}
@@ -0,0 +1,149 @@
+/**
+ * @file test_hpp.cpp
+ * @brief The C++ interface: compile-time schemas, typed values and error messages.
+ *
+ * Built with `-DTEST_HPP_DUPLICATE` it declares a schema with a repeated name,
+ * which must fail to compile; the `test_hpp_duplicate` test checks that it does.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "tinyargs.hpp"
+#include "tinyargs_test.h"
+
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+using tinyargs::option;
+
+static constexpr tinyargs::schema cli{
+    option{ "-v", "--verbose", ARG_TYPE_FLAG,     false, "Verbose output" },
+    option{ "-j", "--jobs",    ARG_TYPE_INT,      false, "Parallel jobs", "TEST_HPP_JOBS" },
+    option{ "-n", "--name",    ARG_TYPE_VALUE,    true,  "Name to greet" },
+    option{ "-t", "--timeout", ARG_TYPE_DURATION, false, "Time limit" },
+    option{ "-r", "--ratio",   ARG_TYPE_DOUBLE,   false, "Ratio" },
+    option{ nullptr, "--limit", ARG_TYPE_SIZE,    false, "Size limit" },
+    option{ "-I", "--include", ARG_TYPE_LIST,     false, "Include directory" } };
+
+#ifdef TEST_HPP_DUPLICATE
+/* A short name equal to another argument's long name is a duplicate too. */
+static constexpr tinyargs::schema duplicate{
+    option{ "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose output" },
+    option{ "--verbose", nullptr, ARG_TYPE_FLAG, false, "Again" } };
+#endif
+
+/* Names resolve to handles at compile time, through the same index the library probes. */
+static_assert(cli.id("--jobs") == 1);
+static_assert(cli.id("-t") == 3);
+static_assert(cli.find("--jbos") == -1);
+
+/* Mutable copies of the tokens, as `argv` must be. */
+struct test_argv {
+    std::vector<std::string> text;
+    std::vector<char *> ptrs;
+
+    test_argv(std::initializer_list<const char *> tokens) : text(tokens.begin(), tokens.end()) {
+        for (std::string &token : text) {
+            ptrs.push_back(token.data());
+        }
+    }
+    int argc() const { return (int)ptrs.size(); }
+    char **argv() { return ptrs.data(); }
+};
+
+static void test_schema(void) {
+    unsetenv("TEST_HPP_JOBS");
+    tinyargs::parser parser{ cli };
+    test_argv args{ "prog", "--verb", "-n", "x", "-j", "3", "--timeout=1.5s", "-r", "0.25",
+                    "--limit", "4K", "-Ia", "--include=b", "pos" };
+    CHECK(parser.parse(args.argc(), args.argv()));
+    CHECK(parser.get<bool>("--verbose") == true);
+    CHECK(parser.get<int>(cli.id("--jobs")) == 3);
+    CHECK(parser.get<unsigned>("-j") == 3u);
+    CHECK(parser.get<std::chrono::milliseconds>("-t") == 1500ms);
+    CHECK(parser.get<std::chrono::seconds>("--timeout") == 1s);
+    CHECK(parser.get<double>("--ratio") == 0.25);
+    CHECK(parser.get<std::size_t>("--limit") == 4096u);
+    CHECK(parser.value("--name") == "x");
+    CHECK(parser.get<std::string_view>(cli.id("-n")) == "x");
+    CHECK(parser.positionals().size() == 1);
+    if (parser.positionals().size() == 1) {
+        CHECK(std::string_view(parser.positionals()[0]) == "pos");
+    }
+
+    /* A value of another type, or one that does not fit, is nullopt. */
+    CHECK(!parser.get<int>("--ratio"));
+    CHECK(!parser.get<std::chrono::seconds>("--jobs"));
+    CHECK(!parser.get<double>("--timeout"));
+    test_argv big{ "prog", "-n", "x", "-j", "300" };
+    CHECK(parser.parse(big.argc(), big.argv()));
+    CHECK(parser.get<int>("-j") == 300);
+    CHECK(!parser.get<std::int8_t>("-j"));
+
+    /* Unset arguments have no value; fallbacks still apply. */
+    setenv("TEST_HPP_JOBS", "6", 1);
+    parser.reset();
+    test_argv bare{ "prog", "--name", "y" };
+    CHECK(parser.parse(bare.argc(), bare.argv()));
+    CHECK(parser.get<bool>("-v") == false);
+    CHECK(parser.get<int>("--jobs") == 6);
+    CHECK(!parser.value("--timeout"));
+    CHECK(!parser.get<std::chrono::milliseconds>("--timeout"));
+    unsetenv("TEST_HPP_JOBS");
+}
+
+static void test_errors(void) {
+    tinyargs::parser parser{ cli };
+    test_output_t out;
+    test_capture_to(parser.get(), &out);
+    test_argv missing{ "prog", "-v" };
+    CHECK(!parser.parse(missing.argc(), missing.argv()));
+    CHECK(parser.error().code == ARG_ERROR_MISSING_REQUIRED);
+    CHECK(parser.error_message() == "Error: Missing required argument --name\n");
+    CHECK(parser.error_message() == out.text);
+
+    test_argv typo{ "prog", "-n", "x", "--verbsoe" };
+    CHECK(!parser.parse(typo.argc(), typo.argv()));
+    CHECK(parser.error_message() == "Error: Unrecognized argument --verbsoe (did you mean --verbose?)\n");
+
+    test_argv invalid{ "prog", "-n", "x", "--jobs=zz" };
+    CHECK(!parser.parse(invalid.argc(), invalid.argv()));
+    CHECK(parser.error().code == ARG_ERROR_INVALID_VALUE);
+    CHECK(parser.error_message() == "Error: Invalid value for argument --jobs: zz\n");
+
+    test_argv good{ "prog", "-n", "x" };
+    CHECK(parser.parse(good.argc(), good.argv()));
+    CHECK(parser.error_message().empty());
+}
+
+/* A parser built at run time, and moves between handles of both kinds. */
+static void test_dynamic(void) {
+    tinyargs::parser parser;
+    arg_id_t verbose = parser.add(option{ "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose output" });
+    arg_id_t timeout = parser.add(option{ "-t", "--timeout", ARG_TYPE_DURATION, false, "Time limit" });
+    CHECK(verbose == 0 && timeout == 1);
+    test_argv args{ "prog", "-v", "-t", "250ms" };
+    CHECK(parser.parse(args.argc(), args.argv()));
+    CHECK(parser.is_set(verbose));
+    CHECK(parser.get<std::chrono::microseconds>(timeout) == 250000us);
+
+    tinyargs::parser moved{ std::move(parser) };
+    CHECK(moved.get() != nullptr && parser.get() == nullptr);
+    CHECK(moved.is_set("--verbose"));
+    moved = tinyargs::parser{ cli };
+    test_argv frozen{ "prog", "-n", "z" };
+    CHECK(moved.parse(frozen.argc(), frozen.argv()));
+    CHECK(moved.value("-n") == "z");
+}
+
+int main(void) {
+    test_schema();
+    test_errors();
+    test_dynamic();
+    TEST_DONE();
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_output.c
+ * @brief Help layout and wrapping, buffer formatting and the output sink.
+ */
+
+#include "tinyargs_test.h"
+
+static const char expected_help[] =
+    "Usage:\n"
+    "  -v, --verbose  Print every step of the build as it runs, including the\n"
+    "                 commands that are executed and the time each of them takes\n"
+    "                 (Type: Flag)\n"
+    "  -j, --jobs     Parallel jobs (Type: Integer)\n"
+    "      --an-extremely-long-option-name-here\n"
+    "                 Long name (Type: Key=Value)\n"
+    "  -q             (Type: Flag)\n";
+
+static arg_parser_t* output_cli(void) {
+    arg_parser_t *parser = arg_parser_create();
+    arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false,
+                   "Print every step of the build as it runs, including the commands that are executed "
+                   "and the time each of them takes");
+    arg_parser_add(parser, "-j", "--jobs", ARG_TYPE_INT, true, "Parallel  jobs");
+    arg_parser_add(parser, NULL, "--an-extremely-long-option-name-here", ARG_TYPE_VALUE, false, "Long name");
+    arg_parser_add(parser, "-q", NULL, ARG_TYPE_FLAG, false, NULL);
+    return parser;
+}
+
+static void test_help_layout(void) {
+    arg_parser_t *parser = output_cli();
+    char buf[1024];
+    size_t len = arg_parser_format_help(parser, buf, sizeof(buf));
+    CHECK(len == sizeof(expected_help) - 1);
+    CHECK_STR(buf, expected_help);
+    /* No line runs past ARG_HELP_WIDTH. */
+    size_t column = 0;
+    for (const char *p = buf; *p; p++) {
+        column = *p == '\n' ? 0 : column + 1;
+        CHECK(column <= ARG_HELP_WIDTH);
+    }
+    arg_parser_free(parser);
+}
+
+/* Like snprintf: truncated and terminated, with the full length returned. */
+static void test_help_truncation(void) {
+    arg_parser_t *parser = output_cli();
+    CHECK(arg_parser_format_help(parser, NULL, 0) == sizeof(expected_help) - 1);
+    char small[16];
+    memset(small, 'x', sizeof(small));
+    CHECK(arg_parser_format_help(parser, small, sizeof(small)) == sizeof(expected_help) - 1);
+    CHECK(small[sizeof(small) - 1] == '\0');
+    CHECK(strncmp(small, expected_help, sizeof(small) - 1) == 0);
+    char one[1] = { 'x' };
+    arg_parser_format_help(parser, one, 1);
+    CHECK(one[0] == '\0');
+    arg_parser_free(parser);
+}
+
+/* The sink gets each listing or message whole, in one call. */
+static void test_sink(void) {
+    arg_parser_t *parser = output_cli();
+    test_output_t out;
+    test_capture_to(parser, &out);
+    arg_parser_print_help(parser);
+    CHECK(out.writes == 1);
+    CHECK(out.kind == ARG_OUTPUT_HELP);
+    CHECK_STR(out.text, expected_help);
+
+    test_capture_to(parser, &out);
+    char *argv[] = { "prog", "-v" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK(out.writes == 1);
+    CHECK(out.kind == ARG_OUTPUT_ERROR);
+    CHECK_STR(out.text, "Error: Missing required argument --jobs\n");
+
+    char buf[64];
+    CHECK(arg_parser_format_error(parser, buf, sizeof(buf)) == out.len);
+    CHECK_STR(buf, out.text);
+    char small[8];
+    CHECK(arg_parser_format_error(parser, small, sizeof(small)) == out.len);
+    CHECK_STR(small, "Error: ");
+
+    char *good[] = { "prog", "-j", "2" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(good), good));
+    CHECK(arg_parser_format_error(parser, buf, sizeof(buf)) == 0);
+    CHECK_STR(buf, "");
+    arg_parser_free(parser);
+}
+
+int main(void) {
+    test_help_layout();
+    test_help_truncation();
+    test_sink();
+    TEST_DONE();
+}
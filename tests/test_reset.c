@@ -0,0 +1,218 @@
+/**
+ * @file test_reset.c
+ * @brief Accumulation across parses and `arg_parser_reset`.
+ */
+
+#include "tinyargs_test.h"
+#include <stdlib.h>
+#include <wchar.h>
+
+static size_t alloc_calls;
+static int alloc_fail;
+
+static void* counting_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    alloc_calls++;
+    return alloc_fail ? NULL : malloc(size);
+}
+
+static void counting_free(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+static int build_run(arg_parser_t *parser, void *ctx) {
+    (void)ctx;
+    arg_parser_add(parser, "-f", "--fast", ARG_TYPE_FLAG, false, "Fast");
+    return 1;
+}
+
+typedef struct {
+    arg_parser_t *parser;
+    arg_id_t verbose;
+    arg_id_t name;
+    arg_id_t jobs;
+    arg_id_t include;
+} reset_cli_t;
+
+static void reset_cli_init(reset_cli_t *cli, arg_parser_t *parser) {
+    cli->parser = parser;
+    cli->verbose = arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose");
+    cli->name = arg_parser_add(parser, "-n", "--name", ARG_TYPE_VALUE, false, "Name");
+    cli->jobs = arg_parser_add(parser, "-j", "--jobs", ARG_TYPE_INT, false, "Jobs");
+    cli->include = arg_parser_add(parser, "-I", "--include", ARG_TYPE_LIST, false, "Include");
+}
+
+static void test_accumulate(void) {
+    reset_cli_t cli;
+    reset_cli_init(&cli, arg_parser_create());
+    char *first[] = { "prog", "-v", "-n", "a", "-I", "x", "pos" };
+    char *second[] = { "prog", "-j", "4", "-I", "y" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(first), first));
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(second), second));
+    /* Without a reset, the first parse's flags stay set; values are those of the latest vector. */
+    CHECK(arg_parser_is_flag_set(cli.parser, "-v"));
+    CHECK(arg_parser_get_value(cli.parser, "-n") == NULL);
+    CHECK(!arg_parser_is_flag_set(cli.parser, "-n"));
+    CHECK(arg_parser_get_int(cli.parser, "-j", 0) == 4);
+    int count = 0;
+    const arg_ref_t *items = arg_parser_get_values(cli.parser, cli.include, &count);
+    CHECK(count == 1);
+    if (items && count == 1) {
+        CHECK_STR(second[items[0].index] + items[0].offset, "y");
+    }
+    CHECK(arg_parser_get_positionals(cli.parser).count == 0);
+
+    arg_parser_reset(cli.parser);
+    CHECK(!arg_parser_is_flag_set(cli.parser, "-v"));
+    CHECK(arg_parser_get_value_id(cli.parser, cli.name) == NULL);
+    CHECK(arg_parser_get_typed_id(cli.parser, cli.jobs) == NULL);
+    CHECK(arg_parser_get_values(cli.parser, cli.include, &count) == NULL || count == 0);
+    CHECK(count == 0);
+    CHECK(arg_parser_get_positionals(cli.parser).count == 0);
+
+    /* The error goes too. */
+    test_output_t out;
+    test_capture_to(cli.parser, &out);
+    char *bad[] = { "prog", "-x" };
+    CHECK(!arg_parser_parse(cli.parser, TEST_ARGC(bad), bad));
+    arg_parser_reset(cli.parser);
+    CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_NONE);
+    CHECK(arg_parser_format_error(cli.parser, NULL, 0) == 0);
+
+    /* Registered arguments survive. */
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(second), second));
+    CHECK(!arg_parser_is_flag_set(cli.parser, "-v"));
+    CHECK(arg_parser_get_int(cli.parser, "--jobs", 0) == 4);
+    arg_parser_free(cli.parser);
+}
+
+/* A reset-and-parse loop allocates nothing once the parser has seen vectors of the size. */
+static void test_no_allocation(void) {
+    reset_cli_t cli;
+    reset_cli_init(&cli, arg_parser_create_with_allocator(counting_alloc, counting_free, NULL));
+    char *argv[] = { "prog", "-v", "-j", "2", "-I", "a", "-I", "b", "-I", "c", "one", "two" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    arg_parser_reset(cli.parser);
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    size_t before = alloc_calls;
+    for (int i = 0; i < 1000; i++) {
+        arg_parser_reset(cli.parser);
+        if (!arg_parser_parse(cli.parser, TEST_ARGC(argv), argv)) {
+            CHECK(!"parse failed");
+            break;
+        }
+    }
+    CHECK(alloc_calls == before);
+    int count = 0;
+    arg_parser_get_values(cli.parser, cli.include, &count);
+    CHECK(count == 3);
+    CHECK(arg_parser_get_positionals(cli.parser).count == 2);
+    arg_parser_free(cli.parser);
+}
+
+/* No positional span is left over from an earlier parse. */
+static void check_no_positionals(arg_parser_t *parser) {
+    arg_span_t span = arg_parser_get_positionals(parser);
+    CHECK(span.first == 0 && span.count == 0);
+}
+
+/* A failed parse, however it fails, leaves no positionals from the successful one before it. */
+static void test_failed_parse(void) {
+    reset_cli_t cli;
+    reset_cli_init(&cli, arg_parser_create_with_allocator(counting_alloc, counting_free, NULL));
+    test_output_t out;
+    test_capture_to(cli.parser, &out);
+    char *good[] = { "prog", "one", "two", "three", "four", "five", "six" };
+    char *invalid[] = { "prog", "--jobs=zz" };
+    char *unknown[] = { "prog", "-x" };
+    char **failures[] = { invalid, unknown };
+    for (size_t k = 0; k < sizeof(failures) / sizeof(failures[0]); k++) {
+        CHECK(arg_parser_parse(cli.parser, TEST_ARGC(good), good));
+        CHECK(arg_parser_get_positionals(cli.parser).count == 6);
+        CHECK(!arg_parser_parse(cli.parser, 2, failures[k]));
+        check_no_positionals(cli.parser);
+    }
+
+    /*
+     * Out of memory while expanding a response file: the first expansion leaves
+     * a record to reuse, so the second fails only on the room for its tokens.
+     */
+    const char *path = "test_reset.rsp";
+    char *expand[] = { "prog", "@test_reset.rsp" };
+    for (int pass = 0; pass < 2; pass++) {
+        FILE *file = fopen(path, "w");
+        CHECK(file != NULL);
+        if (!file) {
+            break;
+        }
+        for (int i = 0; i < (pass ? 4000 : 6); i++) {
+            fputs(pass ? "-I value\n" : "pos\n", file);
+        }
+        fclose(file);
+        alloc_fail = pass;
+        CHECK(arg_parser_parse(cli.parser, TEST_ARGC(expand), expand) == !pass);
+        alloc_fail = 0;
+        if (!pass) {
+            CHECK(arg_parser_get_positionals(cli.parser).count == 6);
+        }
+    }
+    CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_NO_MEMORY);
+    check_no_positionals(cli.parser);
+    remove(path);
+
+    /* And while narrowing a typed wide value, once the wide state exists. */
+    static wchar_t token[1 << 16];
+    wmemcpy(token, L"--jobs=", 7);
+    wmemset(token + 7, L'1', sizeof(token) / sizeof(token[0]) - 8);
+    wchar_t *bare[] = { L"prog" };
+    wchar_t *wide[] = { L"prog", token };
+    CHECK(arg_parser_parse_w(cli.parser, TEST_ARGC(bare), bare));
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(good), good));
+    alloc_fail = 1;
+    CHECK(!arg_parser_parse_w(cli.parser, TEST_ARGC(wide), wide));
+    alloc_fail = 0;
+    CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_NO_MEMORY);
+    check_no_positionals(cli.parser);
+    arg_parser_free(cli.parser);
+}
+
+/* Subcommand parsers are reset with their parent and nothing stays selected. */
+static void test_commands(void) {
+    arg_parser_t *parser = arg_parser_create();
+    arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose");
+    CHECK(arg_parser_add_command(parser, "run", build_run, NULL, "Run it"));
+    char *argv[] = { "prog", "-v", "run", "--fast" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    arg_parser_t *child = arg_parser_get_command_parser(parser);
+    CHECK(child != NULL);
+    CHECK_STR(arg_parser_get_command(parser), "run");
+    if (child) {
+        CHECK(arg_parser_is_flag_set(child, "--fast"));
+    }
+
+    arg_parser_reset(parser);
+    CHECK(arg_parser_get_command(parser) == NULL);
+    CHECK(arg_parser_get_command_parser(parser) == NULL);
+    CHECK(!arg_parser_is_flag_set(parser, "-v"));
+    if (child) {
+        CHECK(!arg_parser_is_flag_set(child, "--fast"));
+    }
+
+    char *again[] = { "prog", "run" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(again), again));
+    /* The same child is reused, with nothing left over from before the reset. */
+    CHECK(arg_parser_get_command_parser(parser) == child);
+    if (child) {
+        CHECK(!arg_parser_is_flag_set(child, "--fast"));
+    }
+    arg_parser_free(parser);
+}
+
+int main(void) {
+    test_accumulate();
+    test_no_allocation();
+    test_failed_parse();
+    test_commands();
+    TEST_DONE();
+}
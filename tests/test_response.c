@@ -0,0 +1,140 @@
+/**
+ * @file test_response.c
+ * @brief Response files: `@path` expansion, quoting, nesting and repeated parses.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "tinyargs_test.h"
+#include <stdlib.h>
+
+static void write_file(const char *path, const char *text) {
+    FILE *file = fopen(path, "wb");
+    CHECK(file != NULL);
+    if (file) {
+        fputs(text, file);
+        fclose(file);
+    }
+}
+
+static arg_parser_t* response_cli(arg_parser_t *parser) {
+    arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose");
+    arg_parser_add(parser, "-n", "--name", ARG_TYPE_VALUE, false, "Name");
+    arg_parser_add(parser, "-I", "--include", ARG_TYPE_LIST, false, "Include");
+    return parser;
+}
+
+static void test_expansion(void) {
+    write_file("test_response_a.txt", "-v --name 'two words'\n  -I \"a b\" -I c\\ d @test_response_b.txt");
+    write_file("test_response_b.txt", "pos1 \"quoted \\\"inner\\\"\"");
+    arg_parser_t *parser = response_cli(arg_parser_create());
+    char *argv[] = { "prog", "@test_response_a.txt", "tail", "@missing_response.txt" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_is_flag_set(parser, "--verbose"));
+    CHECK_STR(arg_parser_get_value(parser, "--name"), "two words");
+    int count = 0;
+    const arg_ref_t *items = arg_parser_get_values(parser, arg_parser_find(parser, "-I"), &count);
+    CHECK(count == 2);
+    arg_span_t span = arg_parser_get_positionals(parser);
+    CHECK(span.count == 4);
+    if (items && count == 2 && span.count == 4) {
+        CHECK_STR(span.argv[items[0].index] + items[0].offset, "a b");
+        CHECK_STR(span.argv[items[1].index] + items[1].offset, "c d");
+        CHECK_STR(span.argv[span.first], "pos1");
+        CHECK_STR(span.argv[span.first + 1], "quoted \"inner\"");
+        CHECK_STR(span.argv[span.first + 2], "tail");
+        /* A file that cannot be read stays an ordinary token. */
+        CHECK_STR(span.argv[span.first + 3], "@missing_response.txt");
+    }
+    arg_parser_free(parser);
+    remove("test_response_a.txt");
+    remove("test_response_b.txt");
+}
+
+/* A file that includes itself stops expanding at the depth limit instead of recursing forever. */
+static void test_recursion(void) {
+    write_file("test_response_self.txt", "-v @test_response_self.txt");
+    arg_parser_t *parser = response_cli(arg_parser_create());
+    char *argv[] = { "prog", "@test_response_self.txt" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    arg_span_t span = arg_parser_get_positionals(parser);
+    CHECK(span.count == 1);
+    if (span.count == 1) {
+        CHECK_STR(span.argv[span.first], "@test_response_self.txt");
+    }
+    arg_parser_free(parser);
+    remove("test_response_self.txt");
+}
+
+static int count_maps(void) {
+    FILE *maps = fopen("/proc/self/maps", "r");
+    if (!maps) {
+        return -1;
+    }
+    int lines = 0;
+    for (int c; (c = fgetc(maps)) != EOF;) {
+        lines += c == '\n';
+    }
+    fclose(maps);
+    return lines;
+}
+
+static size_t chunk_bytes;
+
+static void* counting_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    chunk_bytes += size;
+    return malloc(size);
+}
+
+static void counting_free(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+/*
+ * Parsing `@file` over and over on one parser must not accumulate mappings or
+ * arena memory: each parse releases the previous parse's files.
+ */
+static void test_repeated(const char *path, const char *contents) {
+    write_file(path, contents);
+    arg_parser_t *parser = response_cli(arg_parser_create_with_allocator(counting_alloc, counting_free, NULL));
+    char token[64];
+    snprintf(token, sizeof(token), "@%s", path);
+    char *argv[] = { "prog", token };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    int maps_before = count_maps();
+    size_t bytes_before = chunk_bytes;
+    for (int i = 0; i < 2000; i++) {
+        if (!arg_parser_parse(parser, TEST_ARGC(argv), argv)) {
+            CHECK(!"repeated parse failed");
+            break;
+        }
+    }
+    CHECK(arg_parser_is_flag_set(parser, "-v"));
+    CHECK_STR(arg_parser_get_value(parser, "--name"), "x");
+    if (maps_before >= 0) {
+        CHECK(count_maps() <= maps_before);
+    }
+    CHECK(chunk_bytes == bytes_before);
+    arg_parser_reset(parser);
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK_STR(arg_parser_get_value(parser, "-n"), "x");
+    arg_parser_free(parser);
+    remove(path);
+}
+
+int main(void) {
+    test_expansion();
+    test_recursion();
+    /* Mapped in place. */
+    test_repeated("test_response_mapped.txt", "-v --name x\n");
+    /* A whole number of pages leaves no room for a terminator in the mapping, so the file is read instead. */
+    static char page[4096 + 1];
+    memset(page, ' ', 4096);
+    memcpy(page, "-v --name x", 11);
+    test_repeated("test_response_read.txt", page);
+    TEST_DONE();
+}
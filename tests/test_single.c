@@ -0,0 +1,40 @@
+/**
+ * @file test_single.c
+ * @brief The generated single header, compiled with its implementation into this file.
+ *
+ * Not linked against the library: every definition comes from
+ * `single_include/tinyargs.h`, so a header that falls out of step with the
+ * sources, or an implementation that no longer compiles on its own, fails here.
+ */
+
+#define TINYARGS_IMPLEMENTATION
+#include "tinyargs_test.h"
+
+static void test_parse(void) {
+    arg_parser_t *parser = arg_parser_create();
+    arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose output");
+    arg_parser_add(parser, "-j", "--jobs", ARG_TYPE_INT, false, "Parallel jobs");
+    arg_parser_add(parser, "-n", "--name", ARG_TYPE_VALUE, true, "Name to greet");
+    arg_id_t include = arg_parser_add(parser, "-I", "--include", ARG_TYPE_LIST, false, "Include directory");
+    char *argv[] = { "prog", "pos", "--verb", "-j4", "--name=x", "-Ia", "-I", "b" };
+    CHECK(arg_parser_parse(parser, TEST_ARGC(argv), argv));
+    CHECK(arg_is_set(parser, "--verbose"));
+    CHECK(arg_parser_get_int(parser, "--jobs", 0) == 4);
+    CHECK_STR(arg_get(parser, "-n"), "x");
+    int count = 0;
+    arg_parser_get_values(parser, include, &count);
+    CHECK(count == 2);
+    CHECK(arg_parser_get_positionals(parser).count == 1);
+
+    test_output_t out;
+    test_capture_to(parser, &out);
+    char *typo[] = { "prog", "-n", "x", "--verbsoe" };
+    CHECK(!arg_parser_parse(parser, TEST_ARGC(typo), typo));
+    CHECK_STR(out.text, "Error: Unrecognized argument --verbsoe (did you mean --verbose?)\n");
+    arg_parser_free(parser);
+}
+
+int main(void) {
+    test_parse();
+    TEST_DONE();
+}
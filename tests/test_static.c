@@ -0,0 +1,73 @@
+/**
+ * @file test_static.c
+ * @brief Parsers over a static table: parsing, reset and free without the heap.
+ *
+ * Built with `-Wextra -Werror`, so the table below also checks that both
+ * initializer forms shown for `ARG_PARSER_STATIC` compile without warnings.
+ */
+
+#include "tinyargs_test.h"
+
+ARG_PARSER_STATIC(cli,
+    { "-v", "--verbose", ARG_TYPE_FLAG,     false, "Verbose output", NULL },
+    { "-n", "--name",    ARG_TYPE_VALUE,    true,  "Name to greet",  NULL },
+    { "-j", "--jobs",    ARG_TYPE_INT,      false, "Parallel jobs",  NULL },
+    { .short_name = "-t", .long_name = "--timeout", .type = ARG_TYPE_DURATION, .description = "Time limit" },
+    { .long_name = "--ratio", .type = ARG_TYPE_DOUBLE, .description = "Ratio" });
+
+static size_t heap_calls;
+
+/* Installed as the parser's chunk hooks: any call at all is a failure. */
+static void* refusing_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    (void)size;
+    heap_calls++;
+    return NULL;
+}
+
+static void refusing_free(void *ctx, void *ptr) {
+    (void)ctx;
+    (void)ptr;
+    heap_calls++;
+}
+
+static void test_no_heap(void) {
+    static arg_parser_t parser;
+    CHECK(ARG_PARSER_INIT_STATIC(&parser, cli));
+    parser.arena.alloc = refusing_alloc;
+    parser.arena.free = refusing_free;
+    test_output_t out;
+    test_capture_to(&parser, &out);
+
+    char *argv[] = { "prog", "pos", "--verb", "-n", "x", "-j4", "--timeout=250ms", "--ratio", "0.5" };
+    CHECK(arg_parser_parse(&parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_is_flag_set(&parser, "-v"));
+    CHECK_STR(arg_parser_get_value(&parser, "--name"), "x");
+    CHECK(arg_parser_get_int(&parser, "--jobs", 0) == 4);
+    const arg_value_t *timeout = arg_parser_get_typed_id(&parser, 3);
+    CHECK(timeout && timeout->ns == 250000000);
+    CHECK(arg_parser_get_positionals(&parser).count == 1);
+
+    /* Failures are recorded and rendered in place too. */
+    char *typo[] = { "prog", "-n", "x", "--verbsoe" };
+    CHECK(!arg_parser_parse(&parser, TEST_ARGC(typo), typo));
+    CHECK_STR(out.text, "Error: Unrecognized argument --verbsoe (did you mean --verbose?)\n");
+    char *missing[] = { "prog", "-v" };
+    CHECK(!arg_parser_parse(&parser, TEST_ARGC(missing), missing));
+    CHECK(arg_parser_get_error(&parser)->code == ARG_ERROR_MISSING_REQUIRED);
+
+    arg_parser_reset(&parser);
+    char *again[] = { "prog", "--name", "y" };
+    CHECK(arg_parser_parse(&parser, TEST_ARGC(again), again));
+    CHECK(!arg_parser_is_flag_set(&parser, "--verbose"));
+    CHECK(arg_parser_get_value(&parser, "-j") == NULL);
+    arg_parser_free(&parser);
+
+    CHECK(parser.arena.chunks == NULL);
+    CHECK(heap_calls == 0);
+}
+
+int main(void) {
+    test_no_heap();
+    TEST_DONE();
+}
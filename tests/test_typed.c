@@ -0,0 +1,188 @@
+/**
+ * @file test_typed.c
+ * @brief Typed value conversion: int, double, size and duration arguments.
+ */
+
+#include "tinyargs_test.h"
+#include <locale.h>
+#include <stdint.h>
+
+typedef struct {
+    arg_parser_t *parser;
+    arg_id_t jobs;
+    arg_id_t ratio;
+    arg_id_t cache;
+    arg_id_t timeout;
+} typed_cli_t;
+
+static void typed_cli_init(typed_cli_t *cli) {
+    cli->parser = arg_parser_create();
+    cli->jobs = arg_parser_add(cli->parser, "-j", "--jobs", ARG_TYPE_INT, false, "Jobs");
+    cli->ratio = arg_parser_add(cli->parser, "-r", "--ratio", ARG_TYPE_DOUBLE, false, "Ratio");
+    cli->cache = arg_parser_add(cli->parser, "-c", "--cache", ARG_TYPE_SIZE, false, "Cache");
+    cli->timeout = arg_parser_add(cli->parser, "-t", "--timeout", ARG_TYPE_DURATION, false, "Timeout");
+}
+
+/* Parses a single `name=value` token on a fresh parser; returns whether it was accepted. */
+static bool typed_accepts(const char *token, typed_cli_t *cli) {
+    test_output_t out;
+    typed_cli_init(cli);
+    test_capture_to(cli->parser, &out);
+    char *argv[] = { "prog", (char *)token };
+    return arg_parser_parse(cli->parser, 2, argv) == 1;
+}
+
+static void test_int(void) {
+    typed_cli_t cli;
+    CHECK(typed_accepts("--jobs=8", &cli));
+    CHECK(arg_parser_get_int(cli.parser, "--jobs", 0) == 8);
+    arg_parser_free(cli.parser);
+
+    CHECK(typed_accepts("--jobs=-0x10", &cli));
+    CHECK(arg_parser_get_int(cli.parser, "-j", 0) == -16);
+    arg_parser_free(cli.parser);
+
+    CHECK(typed_accepts("--jobs=9223372036854775807", &cli));
+    CHECK(arg_parser_get_int(cli.parser, "-j", 0) == INT64_MAX);
+    arg_parser_free(cli.parser);
+
+    CHECK(typed_accepts("--jobs=-9223372036854775808", &cli));
+    CHECK(arg_parser_get_int(cli.parser, "-j", 0) == INT64_MIN);
+    arg_parser_free(cli.parser);
+
+    const char *bad[] = { "--jobs=9223372036854775808", "--jobs=-9223372036854775809",
+                          "--jobs=99999999999999999999", "--jobs=", "--jobs=12x", "--jobs=0x", "--jobs= 1" };
+    for (size_t k = 0; k < sizeof(bad) / sizeof(bad[0]); k++) {
+        CHECK(!typed_accepts(bad[k], &cli));
+        CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_INVALID_VALUE);
+        CHECK(arg_parser_get_error(cli.parser)->id == cli.jobs);
+        arg_parser_free(cli.parser);
+    }
+}
+
+static void test_double(void) {
+    static const struct { const char *token; double value; } good[] = {
+        { "--ratio=0.75", 0.75 },
+        { "--ratio=-2.5e3", -2500.0 },
+        { "--ratio=1e-5", 1e-5 },
+        { "--ratio=12345678901234567890.5", 12345678901234567890.5 },
+        { "--ratio=1e300", 1e300 },
+        { "--ratio=+3", 3.0 },
+    };
+    typed_cli_t cli;
+    for (size_t k = 0; k < sizeof(good) / sizeof(good[0]); k++) {
+        CHECK(typed_accepts(good[k].token, &cli));
+        CHECK(arg_parser_get_double(cli.parser, "--ratio", 0.0) == good[k].value);
+        arg_parser_free(cli.parser);
+    }
+    const char *bad[] = { "--ratio=", "--ratio=abc", "--ratio=1.5x", "--ratio= 1" };
+    for (size_t k = 0; k < sizeof(bad) / sizeof(bad[0]); k++) {
+        CHECK(!typed_accepts(bad[k], &cli));
+        CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_INVALID_VALUE);
+        arg_parser_free(cli.parser);
+    }
+}
+
+/* Values are read with '.' whatever the C locale, including on the strtod fallback. */
+static void test_double_locale(void) {
+    const char *names[] = { "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8" };
+    const char *previous = setlocale(LC_NUMERIC, NULL);
+    char saved[64];
+    snprintf(saved, sizeof(saved), "%s", previous ? previous : "C");
+    bool switched = false;
+    for (size_t k = 0; k < sizeof(names) / sizeof(names[0]) && !switched; k++) {
+        switched = setlocale(LC_NUMERIC, names[k]) != NULL;
+    }
+    typed_cli_t cli;
+    CHECK(typed_accepts("--ratio=0.5", &cli));
+    CHECK(arg_parser_get_double(cli.parser, "--ratio", 0.0) == 0.5);
+    arg_parser_free(cli.parser);
+    CHECK(typed_accepts("--ratio=12345678901234567890.25", &cli));
+    CHECK(arg_parser_get_double(cli.parser, "--ratio", 0.0) == 12345678901234567890.25);
+    arg_parser_free(cli.parser);
+    if (!switched) {
+        printf("test_double_locale: no comma-decimal locale installed; checked in the C locale only\n");
+    }
+    setlocale(LC_NUMERIC, saved);
+}
+
+static void test_size(void) {
+    static const struct { const char *token; uint64_t value; } good[] = {
+        { "--cache=0", 0 },
+        { "--cache=512", 512 },
+        { "--cache=4K", 4096 },
+        { "--cache=64M", (uint64_t)64 << 20 },
+        { "--cache=2GiB", (uint64_t)2 << 30 },
+        { "--cache=1tb", (uint64_t)1 << 40 },
+        { "--cache=10B", 10 },
+        { "--cache=16777215T", (uint64_t)16777215 << 40 },
+    };
+    typed_cli_t cli;
+    for (size_t k = 0; k < sizeof(good) / sizeof(good[0]); k++) {
+        CHECK(typed_accepts(good[k].token, &cli));
+        CHECK(arg_parser_get_size(cli.parser, "--cache", 1) == good[k].value);
+        arg_parser_free(cli.parser);
+    }
+    const char *bad[] = { "--cache=16777216T", "--cache=-1", "--cache=4X", "--cache=4KK", "--cache=K" };
+    for (size_t k = 0; k < sizeof(bad) / sizeof(bad[0]); k++) {
+        CHECK(!typed_accepts(bad[k], &cli));
+        CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_INVALID_VALUE);
+        arg_parser_free(cli.parser);
+    }
+}
+
+static void test_duration(void) {
+    static const struct { const char *token; int64_t ns; } good[] = {
+        { "--timeout=5", 5000000000 },
+        { "--timeout=1.5s", 1500000000 },
+        { "--timeout=250ms", 250000000 },
+        { "--timeout=7us", 7000 },
+        { "--timeout=3ns", 3 },
+        { "--timeout=2m", 120000000000 },
+        { "--timeout=1h", 3600000000000 },
+        { "--timeout=0.001ms", 1000 },
+    };
+    typed_cli_t cli;
+    for (size_t k = 0; k < sizeof(good) / sizeof(good[0]); k++) {
+        CHECK(typed_accepts(good[k].token, &cli));
+        CHECK(arg_parser_get_duration(cli.parser, "--timeout", -1) == good[k].ns);
+        arg_parser_free(cli.parser);
+    }
+    const char *bad[] = { "--timeout=-1s", "--timeout=1d", "--timeout=s", "--timeout=9223372037s",
+                          "--timeout=99999999999999999999h" };
+    for (size_t k = 0; k < sizeof(bad) / sizeof(bad[0]); k++) {
+        CHECK(!typed_accepts(bad[k], &cli));
+        CHECK(arg_parser_get_error(cli.parser)->code == ARG_ERROR_INVALID_VALUE);
+        arg_parser_free(cli.parser);
+    }
+}
+
+/* Conversions happen once, while parsing; getters read the cached value and apply defaults. */
+static void test_cached(void) {
+    typed_cli_t cli;
+    typed_cli_init(&cli);
+    char *argv[] = { "prog", "-j", "3", "--cache", "1K" };
+    CHECK(arg_parser_parse(cli.parser, TEST_ARGC(argv), argv));
+    const arg_value_t *jobs = arg_parser_get_typed_id(cli.parser, cli.jobs);
+    CHECK(jobs && jobs->i == 3);
+    CHECK(arg_parser_get_typed_id(cli.parser, cli.jobs) == jobs);
+    argv[2] = "999";
+    CHECK(arg_parser_get_int(cli.parser, "--jobs", 0) == 3);
+    CHECK(arg_parser_get_double(cli.parser, "--ratio", 0.25) == 0.25);
+    CHECK(arg_parser_get_duration(cli.parser, "--timeout", 42) == 42);
+    CHECK(arg_parser_get_typed_id(cli.parser, cli.timeout) == NULL);
+    /* Asking for the wrong type gives the default. */
+    CHECK(arg_parser_get_double(cli.parser, "--jobs", -1.0) == -1.0);
+    CHECK(arg_parser_get_size(cli.parser, "--cache", 0) == 1024);
+    arg_parser_free(cli.parser);
+}
+
+int main(void) {
+    test_int();
+    test_double();
+    test_double_locale();
+    test_size();
+    test_duration();
+    test_cached();
+    TEST_DONE();
+}
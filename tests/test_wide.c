@@ -0,0 +1,189 @@
+/**
+ * @file test_wide.c
+ * @brief Wide argument vectors: values, offsets in `wchar_t` units, reordering and messages.
+ */
+
+#include "tinyargs_test.h"
+#include <wchar.h>
+
+typedef struct {
+    arg_parser_t *parser;
+    arg_id_t verbose;
+    arg_id_t jobs;
+    arg_id_t name;
+    arg_id_t include;
+    arg_id_t cafe;
+} wide_cli_t;
+
+static void wide_cli_init(wide_cli_t *cli) {
+    cli->parser = arg_parser_create();
+    cli->verbose = arg_parser_add(cli->parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose");
+    cli->jobs = arg_parser_add(cli->parser, "-j", "--jobs", ARG_TYPE_INT, false, "Jobs");
+    cli->name = arg_parser_add(cli->parser, "-n", "--name", ARG_TYPE_VALUE, false, "Name");
+    cli->include = arg_parser_add(cli->parser, "-I", "--include", ARG_TYPE_LIST, false, "Include");
+    cli->cafe = arg_parser_add(cli->parser, NULL, "--caf\xc3\xa9", ARG_TYPE_FLAG, false, "Coffee");
+}
+
+static int build_run(arg_parser_t *parser, void *ctx) {
+    (void)ctx;
+    arg_parser_add(parser, "-f", "--fast", ARG_TYPE_FLAG, false, "Fast");
+    return 1;
+}
+
+static void test_values(void) {
+    wide_cli_t cli;
+    wide_cli_init(&cli);
+    wchar_t *argv[] = { L"prog", L"pos", L"--verb", L"--name=h\u00e9llo", L"-Ia", L"--include=\u00fcber",
+                        L"--caf\u00e9", L"--jobs", L"7" };
+    CHECK(arg_parser_parse_w(cli.parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_is_flag_set(cli.parser, "--verbose"));
+    CHECK(arg_parser_is_flag_set(cli.parser, "--caf\xc3\xa9"));
+    CHECK(arg_parser_get_int(cli.parser, "-j", 0) == 7);
+    CHECK_STR(arg_parser_get_value(cli.parser, "--name"), "h\xc3\xa9llo");
+    const wchar_t *name = arg_parser_get_value_w(cli.parser, cli.name);
+    CHECK(name && wcscmp(name, L"h\u00e9llo") == 0);
+
+    /* Options were moved ahead of the positional, and list offsets count wide units. */
+    CHECK(wcscmp(argv[TEST_ARGC(argv) - 1], L"pos") == 0);
+    arg_span_t span = arg_parser_get_positionals(cli.parser);
+    CHECK(span.count == 1 && span.first == TEST_ARGC(argv) - 1);
+    int count = 0;
+    const arg_ref_t *items = arg_parser_get_values(cli.parser, cli.include, &count);
+    CHECK(count == 2);
+    if (items && count == 2) {
+        CHECK(wcscmp(argv[items[0].index] + items[0].offset, L"a") == 0);
+        CHECK(wcscmp(argv[items[1].index] + items[1].offset, L"\u00fcber") == 0);
+    }
+    arg_parser_free(cli.parser);
+}
+
+/* Abbreviations, clusters and attached values match the wide names, and offsets survive reordering. */
+static void test_matching(void) {
+    wide_cli_t cli;
+    wide_cli_init(&cli);
+    wchar_t *argv[] = { L"prog", L"one", L"-vj4", L"two", L"--incl", L"\u00e9", L"--caf", L"-n\u00fc", L"three" };
+    CHECK(arg_parser_parse_w(cli.parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_is_flag_set(cli.parser, "-v"));
+    CHECK(arg_parser_is_flag_set(cli.parser, "--caf\xc3\xa9"));
+    CHECK(arg_parser_get_int(cli.parser, "--jobs", 0) == 4);
+    CHECK_STR(arg_parser_get_value(cli.parser, "--name"), "\xc3\xbc");
+    const wchar_t *name = arg_parser_get_value_w(cli.parser, cli.name);
+    CHECK(name && wcscmp(name, L"\u00fc") == 0);
+    int count = 0;
+    const arg_ref_t *items = arg_parser_get_values(cli.parser, cli.include, &count);
+    CHECK(count == 1 && items && wcscmp(argv[items[0].index] + items[0].offset, L"\u00e9") == 0);
+    arg_span_t span = arg_parser_get_positionals(cli.parser);
+    CHECK(span.count == 3 && span.first == TEST_ARGC(argv) - 3);
+    CHECK(wcscmp(argv[span.first], L"one") == 0 && wcscmp(argv[span.first + 2], L"three") == 0);
+
+    /* The schema grew since the names were encoded. */
+    arg_parser_add(cli.parser, NULL, "--na\xc3\xafve", ARG_TYPE_FLAG, false, "Naive");
+    wchar_t *again[] = { L"prog", L"--na\u00efve" };
+    CHECK(arg_parser_parse_w(cli.parser, TEST_ARGC(again), again));
+    CHECK(arg_parser_is_flag_set(cli.parser, "--na\xc3\xafve"));
+    arg_parser_free(cli.parser);
+}
+
+/* A matcher standing in for a generated one, over the names of `wide_cli_init`. */
+static int wide_lookup(const char *name, size_t len) {
+    static const char *names[] = { "-v", "--verbose", "-j", "--jobs", "-n", "--name", "-I", "--include", "--caf\xc3\xa9" };
+    static const int ids[] = { 0, 0, 1, 1, 2, 2, 3, 3, 4 };
+    for (size_t k = 0; k < sizeof(names) / sizeof(names[0]); k++) {
+        if (strlen(names[k]) == len && memcmp(names[k], name, len) == 0) {
+            return ids[k];
+        }
+    }
+    return -1;
+}
+
+/* A frozen schema with a matcher in place of the index sees the same wide names. */
+static void test_lookup(void) {
+    wide_cli_t cli;
+    wide_cli_init(&cli);
+    arg_schema_t schema = *arg_parser_freeze(cli.parser);
+    schema.index = NULL;
+    schema.index_size = 0;
+    schema.lookup = wide_lookup;
+    static uint64_t buf[(ARG_RESULT_SIZE(5) + 7) / 8];
+    arg_parser_t parser;
+    CHECK(arg_parser_init_schema(&parser, &schema, buf));
+    wchar_t *argv[] = { L"prog", L"--caf\u00e9", L"--verb", L"-j", L"5", L"--includes", L"x" };
+    CHECK(arg_parser_parse_w(&parser, 3, argv));
+    CHECK(arg_parser_is_flag_set(&parser, "--caf\xc3\xa9") && arg_parser_is_flag_set(&parser, "-v"));
+    CHECK(arg_parser_parse_w(&parser, 5, argv));
+    CHECK(arg_parser_get_int(&parser, "--jobs", 0) == 5);
+    test_output_t out;
+    test_capture_to(&parser, &out);
+    CHECK(!arg_parser_parse_w(&parser, TEST_ARGC(argv), argv));
+    CHECK_STR(out.text, "Error: Unrecognized argument --includes (did you mean --include?)\n");
+    arg_parser_free(&parser);
+    arg_parser_free(cli.parser);
+}
+
+/* Typed values are converted whatever their length. */
+static void test_long_typed(void) {
+    wide_cli_t cli;
+    wide_cli_init(&cli);
+    wchar_t value[300];
+    for (size_t k = 0; k < 297; k++) {
+        value[k] = L'0';
+    }
+    wcscpy(value + 297, L"42");
+    wchar_t *argv[] = { L"prog", L"-j", value };
+    CHECK(arg_parser_parse_w(cli.parser, TEST_ARGC(argv), argv));
+    CHECK(arg_parser_get_int(cli.parser, "--jobs", 0) == 42);
+    const arg_value_t *jobs = arg_parser_get_typed_id(cli.parser, cli.jobs);
+    CHECK(jobs && jobs->i == 42);
+    arg_parser_free(cli.parser);
+}
+
+static void test_errors(void) {
+    wide_cli_t cli;
+    wide_cli_init(&cli);
+    test_output_t out;
+    test_capture_to(cli.parser, &out);
+    wchar_t *flag[] = { L"prog", L"--caf\u00e9=x" };
+    CHECK(!arg_parser_parse_w(cli.parser, TEST_ARGC(flag), flag));
+    const arg_error_t *error = arg_parser_get_error(cli.parser);
+    CHECK(error->code == ARG_ERROR_UNEXPECTED_VALUE);
+    CHECK(error->index == 1 && error->offset == 7);
+    CHECK_STR(out.text, "Error: Argument --caf\xc3\xa9 does not take a value\n");
+
+    test_capture_to(cli.parser, &out);
+    wchar_t *invalid[] = { L"prog", L"--jobs=\u00e9" };
+    CHECK(!arg_parser_parse_w(cli.parser, TEST_ARGC(invalid), invalid));
+    CHECK(arg_parser_get_error(cli.parser)->offset == 7);
+    CHECK_STR(out.text, "Error: Invalid value for argument --jobs: \xc3\xa9\n");
+    char buf[128];
+    arg_parser_format_error(cli.parser, buf, sizeof(buf));
+    CHECK_STR(buf, out.text);
+
+    test_capture_to(cli.parser, &out);
+    wchar_t *typo[] = { L"prog", L"--verbsoe" };
+    CHECK(!arg_parser_parse_w(cli.parser, TEST_ARGC(typo), typo));
+    CHECK_STR(out.text, "Error: Unrecognized argument --verbsoe (did you mean --verbose?)\n");
+    arg_parser_free(cli.parser);
+}
+
+/* The subcommand name is matched through its narrowed token, and the child parses the wide rest. */
+static void test_commands(void) {
+    arg_parser_t *parser = arg_parser_create();
+    arg_parser_add(parser, "-v", "--verbose", ARG_TYPE_FLAG, false, "Verbose");
+    CHECK(arg_parser_add_command(parser, "r\xc3\xbcn", build_run, NULL, "Run it"));
+    wchar_t *argv[] = { L"prog", L"-v", L"r\u00fcn", L"--fast" };
+    CHECK(arg_parser_parse_w(parser, TEST_ARGC(argv), argv));
+    CHECK_STR(arg_parser_get_command(parser), "r\xc3\xbcn");
+    arg_parser_t *child = arg_parser_get_command_parser(parser);
+    CHECK(child && arg_parser_is_flag_set(child, "--fast"));
+    arg_parser_free(parser);
+}
+
+int main(void) {
+    test_values();
+    test_matching();
+    test_lookup();
+    test_long_typed();
+    test_errors();
+    test_commands();
+    TEST_DONE();
+}
@@ -0,0 +1,78 @@
+/**
+ * @file tinyargs_test.h
+ * @brief Minimal check macros and helpers shared by the unit tests.
+ *
+ * Each test is its own executable: checks report the failing line and keep
+ * going, and `TEST_DONE` turns the failure count into the exit status CTest
+ * reads. Parser output is captured through `test_capture`.
+ */
+
+#ifndef TINYARGS_TEST_H
+#define TINYARGS_TEST_H
+
+#include "tinyargs.h"
+#include <stdio.h>
+#include <string.h>
+
+static int test_failures;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_STR(actual, expected) \
+    do { \
+        const char *test_a = (actual); \
+        const char *test_e = (expected); \
+        if (!test_a || strcmp(test_a, test_e) != 0) { \
+            fprintf(stderr, "%s:%d: expected \"%s\", got \"%s\"\n", __FILE__, __LINE__, test_e, \
+                    test_a ? test_a : "(null)"); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_DONE() \
+    do { \
+        if (test_failures) { \
+            fprintf(stderr, "%d check(s) failed\n", test_failures); \
+        } \
+        return test_failures ? 1 : 0; \
+    } while (0)
+
+/**
+ * @struct test_output_t
+ * @brief Text the parser wrote, and how many separate writes it took.
+ */
+typedef struct {
+    char text[8192];
+    size_t len;
+    int writes;
+    arg_output_t kind;
+} test_output_t;
+
+static inline void test_capture(void *ctx, arg_output_t kind, const char *text, size_t len) {
+    test_output_t *out = (test_output_t *)ctx;
+    size_t room = sizeof(out->text) - 1 - out->len;
+    size_t n = len < room ? len : room;
+    memcpy(out->text + out->len, text, n);
+    out->len += n;
+    out->text[out->len] = '\0';
+    out->writes++;
+    out->kind = kind;
+}
+
+/* Routes the parser's output into `out`, emptied first. */
+static inline void test_capture_to(arg_parser_t *parser, test_output_t *out) {
+    out->text[0] = '\0';
+    out->len = 0;
+    out->writes = 0;
+    arg_parser_set_output(parser, test_capture, out);
+}
+
+#define TEST_ARGC(argv) ((int)(sizeof(argv) / sizeof((argv)[0])))
+
+#endif // TINYARGS_TEST_H
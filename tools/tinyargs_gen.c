@@ -0,0 +1,643 @@
+/**
+ * @file tinyargs_gen.c
+ * @brief Generator of specialized parsers for a fixed argument schema.
+ *
+ * Reads a schema and emits a header and a source file that declare the
+ * schema's tables as constants, a matcher that resolves names by switching on
+ * their length and on one distinguishing character before a single memcmp,
+ * and a struct with one typed field per argument. The generated parse function
+ * runs `arg_parser_parse` over the constant schema, so it behaves exactly like
+ * the runtime path, without building a name index at startup.
+ *
+ * The schema is either a file written by `arg_parser_compile_to`, which is how
+ * an existing `arg_t` table is fed in, or a text file with one argument per line:
+ *
+ *     # short  long       type      [required] [env=VAR] [description]
+ *     -h       --help     flag      "Show this help"
+ *     -        --name     value     required   Name to greet
+ *     -j       --jobs     int       env=APP_JOBS "Number of jobs"
+ *
+ * where `-` stands for a missing name and the type is one of flag, value, int,
+ * double, size, duration or list.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "tinyargs.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GEN_LINE_MAX 4096
+#define GEN_FIELD_MAX 64
+
+static const char *const gen_type_names[] = { "flag", "value", "int", "double", "size", "duration", "list" };
+
+static const char *const gen_type_enums[] = {
+    "ARG_TYPE_FLAG", "ARG_TYPE_VALUE", "ARG_TYPE_INT", "ARG_TYPE_DOUBLE",
+    "ARG_TYPE_SIZE", "ARG_TYPE_DURATION", "ARG_TYPE_LIST"
+};
+
+/* C types of typed fields, by argument type; flags, values and lists are handled apart. */
+static const char *const gen_field_types[] = { "bool", "const char *", "int64_t", "double", "uint64_t", "int64_t", NULL };
+
+/* Members of arg_value_t holding the typed fields, by argument type. */
+static const char *const gen_value_members[] = { NULL, NULL, "i", "d", "size", "ns", NULL };
+
+static const char *const gen_reserved[] = {
+    "auto", "bool", "break", "case", "char", "const", "continue", "default", "do", "double", "else",
+    "enum", "extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict",
+    "return", "short", "signed", "sizeof", "static", "struct", "switch", "typedef", "union",
+    "unsigned", "void", "volatile", "while", "parser", "state", "positionals"
+};
+
+static char* gen_strdup(const char *text, size_t len) {
+    char *copy = (char *)malloc(len + 1);
+    if (copy) {
+        memcpy(copy, text, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+/* Splits off the next whitespace-separated word of `*p`, honouring double quotes. */
+static char* gen_word(char **p) {
+    char *s = *p;
+    while (*s && isspace((unsigned char)*s)) {
+        s++;
+    }
+    if (!*s) {
+        *p = s;
+        return NULL;
+    }
+    char *word = s;
+    if (*s == '"') {
+        word = ++s;
+        while (*s && *s != '"') {
+            s++;
+        }
+    } else {
+        while (*s && !isspace((unsigned char)*s)) {
+            s++;
+        }
+    }
+    if (*s) {
+        *s++ = '\0';
+    }
+    *p = s;
+    return word;
+}
+
+static int gen_type(const char *name) {
+    for (size_t t = 0; t < sizeof(gen_type_names) / sizeof(gen_type_names[0]); t++) {
+        if (strcmp(name, gen_type_names[t]) == 0) {
+            return (int)t;
+        }
+    }
+    return -1;
+}
+
+/* Registers the arguments listed in the text schema at `path`; 0 with a message on error. */
+static int gen_load_text(arg_parser_t *parser, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "tinyargs_gen: cannot open %s\n", path);
+        return 0;
+    }
+    char line[GEN_LINE_MAX];
+    int number = 0;
+    int ok = 1;
+    while (ok && fgets(line, sizeof(line), file)) {
+        number++;
+        char *p = line;
+        char *short_name = gen_word(&p);
+        if (!short_name || *short_name == '#') {
+            continue;
+        }
+        char *long_name = gen_word(&p);
+        char *type_name = gen_word(&p);
+        int type = type_name ? gen_type(type_name) : -1;
+        if (!long_name || type < 0) {
+            fprintf(stderr, "tinyargs_gen: %s:%d: expected `short long type`\n", path, number);
+            ok = 0;
+            break;
+        }
+        bool required = false;
+        const char *env = NULL;
+        for (;;) {
+            while (*p && isspace((unsigned char)*p)) {
+                p++;
+            }
+            if (strncmp(p, "required", 8) == 0 && (!p[8] || isspace((unsigned char)p[8]))) {
+                required = true;
+                gen_word(&p);
+            } else if (strncmp(p, "env=", 4) == 0) {
+                char *word = gen_word(&p);
+                env = gen_strdup(word + 4, strlen(word + 4));
+            } else {
+                break;
+            }
+        }
+        /* The rest of the line is the description, optionally quoted. */
+        char *end = p + strlen(p);
+        while (end > p && isspace((unsigned char)end[-1])) {
+            end--;
+        }
+        if (end - p >= 2 && *p == '"' && end[-1] == '"') {
+            p++;
+            end--;
+        }
+        const char *description = end > p ? gen_strdup(p, (size_t)(end - p)) : NULL;
+        const char *s = strcmp(short_name, "-") == 0 ? NULL : gen_strdup(short_name, strlen(short_name));
+        const char *l = strcmp(long_name, "-") == 0 ? NULL : gen_strdup(long_name, strlen(long_name));
+        arg_id_t id = arg_parser_add(parser, s, l, (arg_type_t)type, required, description);
+        if (id < 0 || (env && !arg_parser_bind_env(parser, id, env))) {
+            fprintf(stderr, "tinyargs_gen: %s:%d: cannot add the argument\n", path, number);
+            ok = 0;
+            if (id < 0) {
+                free((void *)s);
+                free((void *)l);
+                free((void *)description);
+            }
+            free((void *)env);
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+/* Releases the strings `gen_load_text` copied into the arguments of `parser`. */
+static void gen_free_text(arg_parser_t *parser) {
+    for (int i = 0; i < parser->schema.count; i++) {
+        const arg_t *arg = &parser->schema.args[i];
+        free((void *)arg->short_name);
+        free((void *)arg->long_name);
+        free((void *)arg->description);
+        free((void *)arg->env);
+    }
+}
+
+static void gen_string(FILE *out, const char *text) {
+    if (!text) {
+        fputs("NULL", out);
+        return;
+    }
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(out, "\\%c", *p);
+        } else if (*p < 0x20 || *p >= 0x7f) {
+            /* Octal escapes cannot swallow a following digit the way hex ones do. */
+            fprintf(out, "\\%03o", *p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/* Argument `i` as it appears on the command line, for messages. */
+static const char* gen_display_name(const arg_schema_t *schema, int i) {
+    const arg_key_t *key = &schema->keys[i];
+    return arg_schema_string(schema, key->long_name ? key->long_name : key->short_name);
+}
+
+/* The member generated next to argument `i`'s field: `has_<f>` for typed values, `<f>_count` for lists, else empty. */
+static void gen_derived_name(const arg_schema_t *schema, int i, char fields[][GEN_FIELD_MAX], char *out) {
+    arg_type_t type = schema->args[i].type;
+    out[0] = '\0';
+    if (type == ARG_TYPE_LIST) {
+        snprintf(out, GEN_FIELD_MAX + 8, "%s_count", fields[i]);
+    } else if (type != ARG_TYPE_FLAG && type != ARG_TYPE_VALUE) {
+        snprintf(out, GEN_FIELD_MAX + 8, "has_%s", fields[i]);
+    }
+}
+
+/*
+ * C identifier for argument `i`'s field, unique among the first `i` arguments' fields.
+ * Returns false, after reporting it, if the field or the member derived from it
+ * takes the name of a member generated for an earlier argument.
+ */
+static bool gen_field_name(const arg_schema_t *schema, int i, char fields[][GEN_FIELD_MAX]) {
+    const char *name = gen_display_name(schema, i);
+    char *field = fields[i];
+    size_t len = 0;
+    while (name && *name == '-') {
+        name++;
+    }
+    if (!name || !*name || isdigit((unsigned char)*name)) {
+        len = (size_t)snprintf(field, GEN_FIELD_MAX, "arg_");
+    }
+    for (; name && *name && len + 1 < GEN_FIELD_MAX - 16; name++) {
+        field[len++] = isalnum((unsigned char)*name) ? *name : '_';
+    }
+    field[len] = '\0';
+    bool clash = false;
+    for (size_t k = 0; k < sizeof(gen_reserved) / sizeof(gen_reserved[0]); k++) {
+        clash = clash || strcmp(field, gen_reserved[k]) == 0;
+    }
+    for (int k = 0; k < i; k++) {
+        clash = clash || strcmp(field, fields[k]) == 0;
+    }
+    if (clash) {
+        snprintf(field + len, GEN_FIELD_MAX - len, "_%d", i);
+    }
+    char derived[GEN_FIELD_MAX + 8];
+    char other[GEN_FIELD_MAX + 8];
+    gen_derived_name(schema, i, fields, derived);
+    for (int k = 0; k < i; k++) {
+        gen_derived_name(schema, k, fields, other);
+        const char *member = NULL;
+        if (*other && strcmp(field, other) == 0) {
+            member = field;
+        } else if (*derived && (strcmp(derived, fields[k]) == 0 || strcmp(derived, other) == 0)) {
+            member = derived;
+        }
+        if (member) {
+            fprintf(stderr, "tinyargs_gen: member %s for %s clashes with a member for %s\n",
+                    member, gen_display_name(schema, i), gen_display_name(schema, k));
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    const char *name;
+    size_t len;
+    int id;
+} gen_name_t;
+
+static int gen_name_cmp(const void *a, const void *b) {
+    const gen_name_t *x = (const gen_name_t *)a;
+    const gen_name_t *y = (const gen_name_t *)b;
+    if (x->len != y->len) {
+        return x->len < y->len ? -1 : 1;
+    }
+    return strcmp(x->name, y->name);
+}
+
+/* Position within names of length `len` that takes the most distinct characters. */
+static size_t gen_pivot(const gen_name_t *names, int count, size_t len) {
+    size_t best = 0;
+    int best_distinct = 0;
+    for (size_t pos = 0; pos < len; pos++) {
+        bool seen[256] = { false };
+        int distinct = 0;
+        for (int k = 0; k < count; k++) {
+            unsigned char c = (unsigned char)names[k].name[pos];
+            distinct += !seen[c];
+            seen[c] = true;
+        }
+        if (distinct > best_distinct) {
+            best = pos;
+            best_distinct = distinct;
+        }
+    }
+    return best;
+}
+
+static void gen_char(FILE *out, unsigned char c) {
+    if (c == '\'' || c == '\\') {
+        fprintf(out, "'\\%c'", c);
+    } else if (c < 0x20 || c >= 0x7f) {
+        fprintf(out, "'\\%03o'", c);
+    } else {
+        fprintf(out, "'%c'", c);
+    }
+}
+
+static bool gen_lookup(FILE *out, arg_parser_t *parser, const char *prefix) {
+    const arg_schema_t *schema = &parser->schema;
+    gen_name_t *names = (gen_name_t *)calloc((size_t)schema->count * 2 + 1, sizeof(gen_name_t));
+    if (!names) {
+        return false;
+    }
+    int count = 0;
+    for (int i = 0; i < schema->count; i++) {
+        const arg_key_t *key = &schema->keys[i];
+        const char *short_name = arg_schema_string(schema, key->short_name);
+        const char *long_name = arg_schema_string(schema, key->long_name);
+        /* A name registered twice resolves to its first argument. */
+        if (short_name && arg_parser_find(parser, short_name) == i) {
+            names[count++] = (gen_name_t){ short_name, key->short_len, i };
+        }
+        if (long_name && (!short_name || strcmp(long_name, short_name) != 0) && arg_parser_find(parser, long_name) == i) {
+            names[count++] = (gen_name_t){ long_name, key->long_len, i };
+        }
+    }
+    qsort(names, (size_t)count, sizeof(gen_name_t), gen_name_cmp);
+
+    fprintf(out, "static int %s_lookup(const char *name, size_t len) {\n", prefix);
+    if (!count) {
+        fputs("    (void)name;\n    (void)len;\n    return -1;\n}\n\n", out);
+        free(names);
+        return true;
+    }
+    fprintf(out, "    switch (len) {\n");
+    for (int first = 0; first < count;) {
+        size_t len = names[first].len;
+        int end = first;
+        while (end < count && names[end].len == len) {
+            end++;
+        }
+        fprintf(out, "        case %zu:\n", len);
+        if (end - first == 1) {
+            fputs("            return memcmp(name, ", out);
+            gen_string(out, names[first].name);
+            fprintf(out, ", %zu) == 0 ? %d : -1;\n", len, names[first].id);
+            first = end;
+            continue;
+        }
+        size_t pivot = gen_pivot(names + first, end - first, len);
+        fprintf(out, "            switch (name[%zu]) {\n", pivot);
+        /* Names of one length are sorted, but not by the pivot character, so collect each character once. */
+        bool done[256] = { false };
+        for (int k = first; k < end; k++) {
+            unsigned char c = (unsigned char)names[k].name[pivot];
+            if (done[c]) {
+                continue;
+            }
+            done[c] = true;
+            fputs("                case ", out);
+            gen_char(out, c);
+            fputs(":\n", out);
+            for (int m = k; m < end; m++) {
+                if ((unsigned char)names[m].name[pivot] != c) {
+                    continue;
+                }
+                fputs("                    if (memcmp(name, ", out);
+                gen_string(out, names[m].name);
+                fprintf(out, ", %zu) == 0) {\n                        return %d;\n                    }\n", len, names[m].id);
+            }
+            fputs("                    return -1;\n", out);
+        }
+        fputs("            }\n            return -1;\n", out);
+        first = end;
+    }
+    fputs("    }\n    return -1;\n}\n\n", out);
+    free(names);
+    return true;
+}
+
+static void gen_header(FILE *out, arg_parser_t *parser, const char *prefix, const char *guard, char fields[][GEN_FIELD_MAX]) {
+    const arg_schema_t *schema = &parser->schema;
+    fprintf(out, "/* Generated by tinyargs_gen; do not edit. */\n\n");
+    fprintf(out, "#ifndef %s\n#define %s\n\n#include \"tinyargs.h\"\n\n", guard, guard);
+    fprintf(out, "/**\n * @brief Parsed arguments, one field per argument of the schema.\n *\n");
+    fprintf(out, " * Values point into the parsed `argv`. Typed fields hold 0 unless the matching\n");
+    fprintf(out, " * `has_` field is set. `parser` can be used with any `arg_parser_*` call.\n */\n");
+    fprintf(out, "typedef struct {\n");
+    for (int i = 0; i < schema->count; i++) {
+        const arg_t *arg = &schema->args[i];
+        const char *f = fields[i];
+        switch (arg->type) {
+            case ARG_TYPE_FLAG:
+                fprintf(out, "    bool %s;\n", f);
+                break;
+            case ARG_TYPE_VALUE:
+                fprintf(out, "    const char *%s;\n", f);
+                break;
+            case ARG_TYPE_LIST:
+                fprintf(out, "    const arg_ref_t *%s;\n    int %s_count;\n", f, f);
+                break;
+            default:
+                fprintf(out, "    %s %s;%s\n    bool has_%s;\n", gen_field_types[arg->type], f,
+                        arg->type == ARG_TYPE_DURATION ? " /* Nanoseconds */" : arg->type == ARG_TYPE_SIZE ? " /* Bytes */" : "", f);
+                break;
+        }
+    }
+    fprintf(out, "    arg_span_t positionals;\n");
+    fprintf(out, "    arg_parser_t parser;\n");
+    if (schema->count) {
+        fprintf(out, "    uint64_t state[(ARG_RESULT_SIZE(%d) + 7) / 8];\n", schema->count);
+    } else {
+        fprintf(out, "    uint64_t state[1];\n");
+    }
+    fprintf(out, "} %s_args_t;\n\n", prefix);
+    fprintf(out, "/**\n * @brief Prepare `args` for parsing; nothing is allocated.\n *\n");
+    fprintf(out, " * @return 1 on success, 0 otherwise.\n */\n");
+    fprintf(out, "int %s_init(%s_args_t *args);\n\n", prefix, prefix);
+    fprintf(out, "/**\n * @brief Parse `argv` and fill in the fields of `args`, as `arg_parser_parse` would.\n *\n");
+    fprintf(out, " * @return 1 if parsing was successful, 0 otherwise.\n */\n");
+    fprintf(out, "int %s_parse(%s_args_t *args, int argc, char *argv[]);\n\n", prefix, prefix);
+    fprintf(out, "/**\n * @brief Release what parsing allocated, such as expanded response files.\n */\n");
+    fprintf(out, "void %s_free(%s_args_t *args);\n\n", prefix, prefix);
+    fprintf(out, "#endif\n");
+}
+
+static bool gen_source(FILE *out, arg_parser_t *parser, const char *prefix, const char *header, char fields[][GEN_FIELD_MAX]) {
+    const arg_schema_t *schema = &parser->schema;
+    int n = schema->count;
+    fprintf(out, "/* Generated by tinyargs_gen; do not edit. */\n\n");
+    fprintf(out, "#include \"%s\"\n#include <string.h>\n\n", header);
+
+    fprintf(out, "static const arg_t %s_table[] = {\n", prefix);
+    for (int i = 0; i < n; i++) {
+        const arg_t *arg = &schema->args[i];
+        fputs("    { ", out);
+        gen_string(out, arg_schema_string(schema, arg->short_name));
+        fputs(", ", out);
+        gen_string(out, arg_schema_string(schema, arg->long_name));
+        fprintf(out, ", %s, %s, ", gen_type_enums[arg->type], arg->required ? "true" : "false");
+        gen_string(out, arg_schema_string(schema, arg->description));
+        fputs(", ", out);
+        gen_string(out, arg_schema_string(schema, arg->env));
+        fputs(" },\n", out);
+    }
+    if (!n) {
+        fputs("    { NULL, NULL, ARG_TYPE_FLAG, false, NULL, NULL }\n", out);
+    }
+    fputs("};\n\n", out);
+
+    fprintf(out, "static arg_key_t %s_keys[] = {\n", prefix);
+    for (int i = 0; i < n; i++) {
+        const arg_key_t *key = &schema->keys[i];
+        fputs("    { ", out);
+        gen_string(out, arg_schema_string(schema, key->short_name));
+        fputs(", ", out);
+        gen_string(out, arg_schema_string(schema, key->long_name));
+        fprintf(out, ", %u, %u, %s },\n", key->short_len, key->long_len, gen_type_enums[key->type]);
+    }
+    if (!n) {
+        fputs("    { NULL, NULL, 0, 0, ARG_TYPE_FLAG }\n", out);
+    }
+    fputs("};\n\n", out);
+
+    size_t words = ARG_BITSET_WORDS(n);
+    fprintf(out, "static uint64_t %s_required[] = {", prefix);
+    for (size_t w = 0; w < words; w++) {
+        fprintf(out, "%s0x%016llxull", w ? ", " : " ", (unsigned long long)schema->required[w]);
+    }
+    fputs(words ? " };\n\n" : " 0 };\n\n", out);
+
+    fprintf(out, "static int %s_sorted[] = {", prefix);
+    for (int k = 0; k < schema->sorted_count; k++) {
+        fprintf(out, "%s%d", k ? (k % 16 ? ", " : ",\n    ") : " ", schema->sorted[k]);
+    }
+    fputs(schema->sorted_count ? " };\n\n" : " 0 };\n\n", out);
+
+    if (!gen_lookup(out, parser, prefix)) {
+        return false;
+    }
+
+    fprintf(out, "static const arg_schema_t %s_schema = {\n", prefix);
+    fprintf(out, "    .args = %s_table,\n    .keys = %s_keys,\n    .required = %s_required,\n", prefix, prefix, prefix);
+    fprintf(out, "    .count = %d,\n    .sorted = %s_sorted,\n    .sorted_count = %d,\n    .sorted_for = %d,\n",
+            n, prefix, schema->sorted_count, n);
+    fprintf(out, "    .dashless = %s,\n    .lists = %s,\n    .lookup = %s_lookup\n};\n\n",
+            schema->dashless ? "true" : "false", schema->lists ? "true" : "false", prefix);
+
+    fprintf(out, "int %s_init(%s_args_t *args) {\n", prefix, prefix);
+    fprintf(out, "    memset(args, 0, sizeof(*args));\n");
+    fprintf(out, "    return arg_parser_init_schema(&args->parser, &%s_schema, args->state);\n}\n\n", prefix);
+
+    fprintf(out, "int %s_parse(%s_args_t *args, int argc, char *argv[]) {\n", prefix, prefix);
+    fprintf(out, "    arg_parser_t *parser = &args->parser;\n");
+    fprintf(out, "    if (!arg_parser_parse(parser, argc, argv)) {\n        return 0;\n    }\n");
+    bool typed = false;
+    for (int i = 0; i < n; i++) {
+        typed = typed || gen_value_members[schema->args[i].type];
+    }
+    if (typed) {
+        fprintf(out, "    const arg_value_t *value;\n");
+    }
+    for (int i = 0; i < n; i++) {
+        const arg_t *arg = &schema->args[i];
+        const char *f = fields[i];
+        switch (arg->type) {
+            case ARG_TYPE_FLAG:
+                fprintf(out, "    args->%s = arg_parser_is_set_id(parser, %d);\n", f, i);
+                break;
+            case ARG_TYPE_VALUE:
+                fprintf(out, "    args->%s = arg_parser_get_value_id(parser, %d);\n", f, i);
+                break;
+            case ARG_TYPE_LIST:
+                fprintf(out, "    args->%s = arg_parser_get_values(parser, %d, &args->%s_count);\n", f, i, f);
+                break;
+            default:
+                /* The value converted while parsing, or from the argument's fallbacks. */
+                fprintf(out, "    value = arg_parser_get_typed_id(parser, %d);\n", i);
+                fprintf(out, "    args->has_%s = value != NULL;\n", f);
+                fprintf(out, "    args->%s = value ? value->%s : 0;\n", f, gen_value_members[arg->type]);
+                break;
+        }
+    }
+    fprintf(out, "    args->positionals = arg_parser_get_positionals(parser);\n");
+    fprintf(out, "    return 1;\n}\n\n");
+
+    fprintf(out, "void %s_free(%s_args_t *args) {\n    arg_parser_free(&args->parser);\n}\n", prefix, prefix);
+    return true;
+}
+
+static const char* gen_basename(const char *path) {
+    const char *slash = strrchr(path, '/');
+#if defined(_WIN32)
+    const char *backslash = strrchr(path, '\\');
+    if (backslash && (!slash || backslash > slash)) {
+        slash = backslash;
+    }
+#endif
+    return slash ? slash + 1 : path;
+}
+
+static bool gen_identifier(const char *text) {
+    if (!*text || isdigit((unsigned char)*text)) {
+        return false;
+    }
+    for (; *text; text++) {
+        if (!isalnum((unsigned char)*text) && *text != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    arg_parser_t *cli = arg_parser_create();
+    arg_parser_add(cli, "-h", "--help", ARG_TYPE_FLAG, false, "Show this help");
+    arg_parser_add(cli, "-s", "--schema", ARG_TYPE_VALUE, false, "Text schema, or a file written by arg_parser_compile_to");
+    arg_parser_add(cli, "-p", "--prefix", ARG_TYPE_VALUE, false, "Prefix of the generated names (default cli)");
+    arg_parser_add(cli, "-o", "--output", ARG_TYPE_VALUE, false, "Path of the generated source file");
+    arg_parser_add(cli, "-H", "--header", ARG_TYPE_VALUE, false, "Path of the generated header file");
+    if (!arg_parser_parse(cli, argc, argv)) {
+        arg_parser_free(cli);
+        return 2;
+    }
+    const char *schema_path = arg_parser_get_value(cli, "--schema");
+    const char *source_path = arg_parser_get_value(cli, "--output");
+    const char *header_path = arg_parser_get_value(cli, "--header");
+    const char *prefix = arg_parser_get_value(cli, "--prefix");
+    bool help = arg_parser_is_flag_set(cli, "--help");
+    if (help || !schema_path || !source_path || !header_path) {
+        arg_parser_print_help(cli);
+        arg_parser_free(cli);
+        return help ? 0 : 2;
+    }
+    prefix = prefix ? prefix : "cli";
+    if (!gen_identifier(prefix)) {
+        fprintf(stderr, "tinyargs_gen: prefix %s is not a C identifier\n", prefix);
+        arg_parser_free(cli);
+        return 2;
+    }
+
+    int status = 1;
+    char (*fields)[GEN_FIELD_MAX] = NULL;
+    arg_parser_t *parser = arg_parser_load_compiled(schema_path);
+    bool text = !parser;
+    if (text) {
+        parser = arg_parser_create();
+        if (!parser || !gen_load_text(parser, schema_path)) {
+            goto done;
+        }
+    }
+    arg_parser_freeze(parser);
+
+    char guard[GEN_FIELD_MAX + 8];
+    size_t len = 0;
+    for (const char *p = prefix; *p && len + 8 < sizeof(guard); p++) {
+        guard[len++] = (char)toupper((unsigned char)*p);
+    }
+    memcpy(guard + len, "_ARGS_H", 8);
+
+    fields = (char (*)[GEN_FIELD_MAX])calloc((size_t)parser->schema.count + 1, GEN_FIELD_MAX);
+    if (!fields) {
+        fprintf(stderr, "tinyargs_gen: out of memory\n");
+        goto done;
+    }
+    /* Names are checked before anything is written, so a rejected schema leaves no output behind. */
+    for (int i = 0; i < parser->schema.count; i++) {
+        if (!gen_field_name(&parser->schema, i, fields)) {
+            goto done;
+        }
+    }
+    FILE *header = fopen(header_path, "w");
+    FILE *source = fopen(source_path, "w");
+    if (header && source) {
+        gen_header(header, parser, prefix, guard, fields);
+        if (!gen_source(source, parser, prefix, gen_basename(header_path), fields)) {
+            fprintf(stderr, "tinyargs_gen: out of memory\n");
+        } else {
+            status = ferror(header) || ferror(source) ? 1 : 0;
+        }
+    } else {
+        fprintf(stderr, "tinyargs_gen: cannot write %s or %s\n", header_path, source_path);
+    }
+    if (header && fclose(header) != 0) {
+        status = 1;
+    }
+    if (source && fclose(source) != 0) {
+        status = 1;
+    }
+done:
+    free(fields);
+    if (text && parser) {
+        gen_free_text(parser);
+    }
+    arg_parser_free(parser);
+    arg_parser_free(cli);
+    return status;
+}